@@ -0,0 +1,724 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+// headless benchmarks for mousetrap rendering primitives, renders into a RenderTexture using an offscreen context
+// usage: mousetrap_bench [--filter <substring>] [--min-time <seconds>] [--output <path>]
+// prints one json object per line: a context header, then one result per benchmark
+//
+
+#include "mousetrap/include/shape.hpp"
+#include "mousetrap/include/shape_batch.hpp"
+#include "mousetrap/include/render_task.hpp"
+#include "mousetrap/include/render_queue.hpp"
+#include "mousetrap/include/render_texture.hpp"
+#include "mousetrap/include/command_list.hpp"
+#include "mousetrap/include/instance_buffer.hpp"
+#include "mousetrap/include/texture.hpp"
+#include "mousetrap/include/image.hpp"
+#include "mousetrap/include/texture_loader.hpp"
+#include "mousetrap/include/texture_readback.hpp"
+
+#ifdef MOUSETRAP_BENCH_OSMESA
+    #include <GL/osmesa.h>
+#else
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+
+using namespace mousetrap;
+
+namespace
+{
+    // ### CONTEXT
+
+    #ifdef MOUSETRAP_BENCH_OSMESA
+
+    std::vector<uint8_t> osmesa_buffer;
+
+    std::string create_offscreen_context()
+    {
+        const int attributes[] = {
+            OSMESA_FORMAT, OSMESA_RGBA,
+            OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+            OSMESA_CONTEXT_MAJOR_VERSION, 3,
+            OSMESA_CONTEXT_MINOR_VERSION, 3,
+            0
+        };
+
+        auto context = OSMesaCreateContextAttribs(attributes, nullptr);
+        if (context == nullptr)
+            return "";
+
+        // context needs a default framebuffer, benchmarks render into a RenderTexture regardless
+
+        osmesa_buffer.resize(16 * 16 * 4);
+        if (not OSMesaMakeCurrent(context, osmesa_buffer.data(), GL_UNSIGNED_BYTE, 16, 16))
+            return "";
+
+        return "osmesa";
+    }
+
+    #else
+
+    std::string create_offscreen_context()
+    {
+        EGLDisplay display = EGL_NO_DISPLAY;
+
+        auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (get_platform_display != nullptr)
+            display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+        EGLint major, minor;
+        if (display == EGL_NO_DISPLAY or not eglInitialize(display, &major, &minor))
+            return "";
+
+        if (not eglBindAPI(EGL_OPENGL_API))
+            return "";
+
+        const EGLint config_attributes[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+
+        EGLConfig config;
+        EGLint n_configs = 0;
+        if (not eglChooseConfig(display, config_attributes, &config, 1, &n_configs) or n_configs == 0)
+            return "";
+
+        const EGLint context_attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+
+        auto context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+        if (context == EGL_NO_CONTEXT)
+            return "";
+
+        // surfaceless, benchmarks render into a RenderTexture
+
+        if (not eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+            return "";
+
+        return "egl";
+    }
+
+    #endif
+
+    bool initialize_glew()
+    {
+        glewExperimental = GL_TRUE;
+        auto status = glewInit();
+
+        // glew built against glx reports a missing glx display for egl contexts, gl functions are loaded regardless
+
+        #ifdef GLEW_ERROR_NO_GLX_DISPLAY
+        if (status == GLEW_ERROR_NO_GLX_DISPLAY)
+            status = GLEW_OK;
+        #endif
+
+        // glewExperimental may leave a GL_INVALID_ENUM behind
+        while (glGetError() != GL_NO_ERROR);
+
+        GL_INITIALIZED = status == GLEW_OK;
+        return GL_INITIALIZED;
+    }
+
+    // ### HARNESS
+
+    struct Options
+    {
+        std::string filter;
+        double min_time = 0.25;
+        std::string output;
+    };
+
+    struct Result
+    {
+        std::string name;
+        size_t size;
+        size_t n_iterations;
+        double median_ns;
+        double min_ns;
+        double max_ns;
+    };
+
+    class Bench
+    {
+        public:
+            Bench(const Options& options, std::ostream& out)
+                : _options(options), _out(out)
+            {}
+
+            /// \param gpu: finish the gl pipeline after each batch, so gpu time is included
+            void run(const std::string& name, size_t size, const std::function<void()>& f, bool gpu = false)
+            {
+                if (not is_selected(name))
+                    return;
+
+                using clock = std::chrono::steady_clock;
+
+                auto time_batch = [&](size_t n) -> double {
+                    auto before = clock::now();
+                    for (size_t i = 0; i < n; ++i)
+                        f();
+
+                    if (gpu)
+                        glFinish();
+
+                    return std::chrono::duration<double, std::nano>(clock::now() - before).count();
+                };
+
+                // warm up and grow the batch until it is long enough to time reliably
+
+                size_t batch_size = 1;
+                while (time_batch(batch_size) < 1e6 and batch_size < (1 << 20))
+                    batch_size *= 2;
+
+                std::vector<double> samples;
+                double total = 0;
+                while (total < _options.min_time * 1e9 or samples.size() < 5)
+                {
+                    auto ns = time_batch(batch_size);
+                    samples.push_back(ns / batch_size);
+                    total += ns;
+                }
+
+                report(name, size, samples, batch_size * samples.size());
+            }
+
+            /// \brief write externally measured samples, in nanoseconds
+            void report(const std::string& name, size_t size, std::vector<double> samples, size_t n_iterations)
+            {
+                if (samples.empty())
+                    return;
+
+                std::sort(samples.begin(), samples.end());
+
+                auto result = Result{
+                    name,
+                    size,
+                    n_iterations,
+                    samples.at(samples.size() / 2),
+                    samples.front(),
+                    samples.back()
+                };
+
+                write(result);
+            }
+
+            bool is_selected(const std::string& name) const
+            {
+                return _options.filter.empty() or name.find(_options.filter) != std::string::npos;
+            }
+
+        private:
+            void write(const Result& result)
+            {
+                _out << std::fixed << std::setprecision(1)
+                     << "{\"benchmark\":\"" << result.name << "\""
+                     << ",\"size\":" << result.size
+                     << ",\"iterations\":" << result.n_iterations
+                     << ",\"median_ns\":" << result.median_ns
+                     << ",\"min_ns\":" << result.min_ns
+                     << ",\"max_ns\":" << result.max_ns
+                     << "}" << std::endl;
+            }
+
+            const Options& _options;
+            std::ostream& _out;
+    };
+
+    std::vector<Vector2f> generate_points(size_t n)
+    {
+        std::vector<Vector2f> out;
+        out.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            float angle = 2 * M_PI * i / n;
+            float radius = 0.25 + 0.2 * ((i * 7919) % 13) / 13.f;
+            out.emplace_back(0.5 + std::cos(angle) * radius, 0.5 + std::sin(angle) * radius);
+        }
+        return out;
+    }
+
+    Vector2f grid_position(size_t i, size_t n)
+    {
+        size_t n_columns = std::ceil(std::sqrt(float(n)));
+        return {float(i % n_columns) / n_columns, float(i / n_columns) / n_columns};
+    }
+
+    // ### BENCHMARKS
+
+    void bench_shapes(Bench& bench)
+    {
+        auto shape = Shape();
+
+        bench.run("shape/as_point", 1, [&](){ shape.as_point({0.5, 0.5}); });
+        bench.run("shape/as_triangle", 3, [&](){ shape.as_triangle({0.1, 0.1}, {0.9, 0.1}, {0.5, 0.9}); });
+        bench.run("shape/as_rectangle", 4, [&](){ shape.as_rectangle({0.1, 0.1}, {0.8, 0.8}); });
+        bench.run("shape/as_line", 2, [&](){ shape.as_line({0.1, 0.1}, {0.9, 0.9}); });
+        bench.run("shape/as_rectangle_frame", 8, [&](){ shape.as_rectangle_frame({0.1, 0.1}, {0.8, 0.8}, 0.05, 0.05); });
+
+        for (size_t n : {16, 256, 4096})
+        {
+            auto points = generate_points(n);
+
+            std::vector<std::pair<Vector2f, Vector2f>> lines;
+            for (size_t i = 0; i + 1 < points.size(); i += 2)
+                lines.push_back({points.at(i), points.at(i+1)});
+
+            bench.run("shape/as_points", n, [&](){ shape.as_points(points); });
+            bench.run("shape/as_lines", n, [&](){ shape.as_lines(lines); });
+            bench.run("shape/as_line_strip", n, [&](){ shape.as_line_strip(points); });
+            bench.run("shape/as_polygon", n, [&](){ shape.as_polygon(points); });
+            bench.run("shape/as_wireframe", n, [&](){ shape.as_wireframe(points); });
+            bench.run("shape/as_circle", n, [&](){ shape.as_circle({0.5, 0.5}, 0.4, n); });
+            bench.run("shape/as_ellipse", n, [&](){ shape.as_ellipse({0.5, 0.5}, 0.4, 0.3, n); });
+            bench.run("shape/as_circular_ring", n, [&](){ shape.as_circular_ring({0.5, 0.5}, 0.4, 0.05, n); });
+            bench.run("shape/as_elliptic_ring", n, [&](){ shape.as_elliptic_ring({0.5, 0.5}, 0.4, 0.3, 0.05, 0.05, n); });
+        }
+    }
+
+    void bench_uploads(Bench& bench)
+    {
+        for (size_t n : {256, 4096})
+        {
+            auto shape = Shape();
+            shape.as_points(generate_points(n));
+
+            std::vector<Vector3f> positions;
+            std::vector<RGBA> colors;
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto point = grid_position(i, n);
+                positions.emplace_back(point.x, point.y, 0);
+                colors.emplace_back(float(i) / n, 0.5, 0.5, 1);
+            }
+
+            bench.run("upload/set_vertex_positions", n, [&](){ shape.set_vertex_positions(0, positions); });
+            bench.run("upload/set_vertex_colors", n, [&](){ shape.set_vertex_colors(0, colors); });
+
+            bench.run("upload/set_vertex_color_per_vertex", n, [&](){
+                for (size_t i = 0; i < n; ++i)
+                    shape.set_vertex_color(i, colors.at(i));
+            });
+
+            bench.run("upload/set_vertex_color_per_vertex_in_edit", n, [&](){
+                shape.begin_edit();
+                for (size_t i = 0; i < n; ++i)
+                    shape.set_vertex_color(i, colors.at(i));
+                shape.commit_edit();
+            });
+
+            for (auto format : {VertexFormat::DEFAULT, VertexFormat::COMPACT})
+            {
+                shape.set_vertex_format(format);
+                auto name = std::string("upload/positions_and_draw_") + (format == VertexFormat::DEFAULT ? "default" : "compact");
+                auto task = RenderTask(&shape);
+                bench.run(name, n, [&](){
+                    shape.set_vertex_positions(0, positions);
+                    task.render();
+                }, true);
+            }
+        }
+    }
+
+    void bench_draws(Bench& bench)
+    {
+        for (size_t n : {100, 1000, 10000})
+        {
+            std::vector<std::unique_ptr<Shape>> shapes;
+            std::vector<std::unique_ptr<RenderTask>> tasks;
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto& shape = *shapes.emplace_back(new Shape());
+                shape.as_rectangle(grid_position(i, n), {0.5f / n, 0.5f / n});
+                tasks.emplace_back(new RenderTask(&shape));
+            }
+
+            bench.run("draw/render_task", n, [&](){
+                for (auto& task : tasks)
+                    task->render();
+            }, true);
+
+            auto queue = RenderQueue();
+            bench.run("draw/render_queue", n, [&](){
+                for (auto& task : tasks)
+                    queue.push(task.get());
+                queue.submit();
+            }, true);
+
+            auto batch = ShapeBatch();
+            auto batch_task = RenderTask(&batch);
+            bench.run("draw/shape_batch_rebuild", n, [&](){
+                batch.clear();
+                for (auto& shape : shapes)
+                    batch.add(*shape);
+                batch_task.render();
+            }, true);
+
+            bench.run("draw/shape_batch_static", n, [&](){
+                batch_task.render();
+            }, true);
+
+            auto instances = InstanceBuffer();
+            instances.create(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto transform = GLTransform();
+                auto offset = grid_position(i, n);
+                transform.translate({offset.x, offset.y});
+                instances.set_instance(i, transform, RGBA(1, 1, 1, 1));
+            }
+
+            auto instanced_task = RenderTask(shapes.front().get());
+            instanced_task.set_instances(&instances);
+            bench.run("draw/instanced", n, [&](){
+                instanced_task.render();
+            }, true);
+
+            auto list = CommandList();
+            auto submitter = CommandSubmitter();
+            bench.run("draw/command_list", n, [&](){
+                list.clear();
+                for (size_t i = 0; i < n; ++i)
+                    list.draw_rectangle(grid_position(i, n), {0.5f / n, 0.5f / n}, RGBA(1, 1, 1, 1));
+                submitter.submit({&list});
+            }, true);
+        }
+    }
+
+    void bench_uniforms(Bench& bench)
+    {
+        static const std::string source = R"(
+            #version 330
+
+            in vec4 _vertex_color;
+            out vec4 _fragment_color;
+
+            uniform float _u0;
+            uniform float _u1;
+            uniform float _u2;
+            uniform float _u3;
+            uniform vec4 _u4;
+            uniform vec4 _u5;
+
+            void main()
+            {
+                _fragment_color = _vertex_color * vec4(_u0, _u1, _u2, _u3) + _u4 * _u5;
+            }
+        )";
+
+        auto shader = Shader();
+        shader.create_from_string(source, ShaderType::FRAGMENT);
+
+        auto shape = Shape();
+        shape.as_rectangle({0.25, 0.25}, {0.5, 0.5});
+
+        float floats[4] = {1, 1, 1, 1};
+        Vector4f vec4s[2] = {Vector4f(0), Vector4f(0)};
+
+        const size_t n = 1000;
+
+        auto task = RenderTask(&shape, &shader);
+        for (size_t i = 0; i < 4; ++i)
+            task.register_float("_u" + std::to_string(i), &floats[i]);
+        task.register_vec4("_u4", &vec4s[0]);
+        task.register_vec4("_u5", &vec4s[1]);
+
+        bench.run("uniforms/registered", n, [&](){
+            for (size_t i = 0; i < n; ++i)
+                task.render();
+        }, true);
+
+        auto transform = GLTransform();
+        bench.run("uniforms/by_name", n, [&](){
+            for (size_t i = 0; i < n; ++i)
+            {
+                GLStateCache::use_program(shader.get_program_id());
+                for (size_t j = 0; j < 4; ++j)
+                    shader.set_uniform_float("_u" + std::to_string(j), floats[j]);
+                shader.set_uniform_vec4("_u4", vec4s[0]);
+                shader.set_uniform_vec4("_u5", vec4s[1]);
+                shape.render(shader, transform);
+            }
+        }, true);
+    }
+
+    void bench_textures(Bench& bench)
+    {
+        for (size_t size : {64, 256, 1024, 2048})
+        {
+            auto image = Image();
+            image.create(size, size, RGBA(1, 0, 1, 1));
+
+            auto texture = Texture();
+            bench.run("texture/create_from_image", size, [&](){ texture.create_from_image(image); }, true);
+
+            if (size <= 1024)
+                bench.run("texture/download", size, [&](){ auto out = texture.download(); });
+
+            // continuous capture, cpu time per frame of queueing a read and resolving finished ones
+
+            auto readback = TextureReadback();
+            bench.run("texture/download_async", size, [&](){
+                readback.read(texture, [](Image){});
+                readback.update();
+            });
+            readback.finish();
+        }
+
+        // minified sprites, a 2048x2048 texture drawn at about 20x20 pixels, mipmapping keeps texel fetches local
+
+        auto image = Image();
+        image.create(2048, 2048, RGBA(1, 0, 1, 1));
+
+        auto texture = Texture();
+        texture.create_from_image(image);
+        bench.run("texture/generate_mipmaps", 2048, [&](){ texture.generate_mipmaps(); }, true);
+
+        const size_t n = 1000;
+        std::vector<std::unique_ptr<Shape>> shapes;
+        std::vector<std::unique_ptr<RenderTask>> tasks;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto& shape = *shapes.emplace_back(new Shape());
+            shape.as_rectangle(grid_position(i, n), {0.02f, 0.02f});
+            shape.set_texture(&texture);
+            tasks.emplace_back(new RenderTask(&shape));
+        }
+
+        auto queue = RenderQueue();
+        for (auto mode : {std::pair{ScaleMode::LINEAR, "linear"}, std::pair{ScaleMode::TRILINEAR, "trilinear"}, std::pair{ScaleMode::ANISOTROPIC, "anisotropic"}})
+        {
+            texture.set_scale_mode(mode.first);
+            bench.run(std::string("texture/minified_sprites_") + mode.second, n, [&](){
+                for (auto& task : tasks)
+                    queue.push(task.get());
+                queue.submit();
+            }, true);
+        }
+    }
+
+    void bench_streaming(Bench& bench)
+    {
+        // hitch duration: a frame is either one synchronous load of all textures, or one call to TextureLoader::update.
+        // max_ns of each result is the longest frame
+
+        if (not bench.is_selected("streaming/"))
+            return;
+
+        using clock = std::chrono::steady_clock;
+        const size_t n_textures = 8;
+
+        for (size_t size : {512, 2048})
+        {
+            auto image = Image();
+            image.create(size, size);
+            for (size_t y = 0; y < size; ++y)
+                for (size_t x = 0; x < size; ++x)
+                    image.set_pixel(x, y, RGBA(float(x) / size, float(y) / size, float((x * y) % 7) / 7, 1));
+
+            auto path = "/tmp/mousetrap_bench_" + std::to_string(size) + ".png";
+            image.save_to_file(path);
+
+            std::vector<double> synchronous_frames;
+            for (size_t i = 0; i < 3; ++i)
+            {
+                std::vector<std::unique_ptr<Texture>> textures;
+                auto before = clock::now();
+                for (size_t j = 0; j < n_textures; ++j)
+                    textures.emplace_back(new Texture())->create_from_file(path);
+                glFinish();
+                synchronous_frames.push_back(std::chrono::duration<double, std::nano>(clock::now() - before).count());
+            }
+
+            bench.report("streaming/synchronous_frame", size, synchronous_frames, synchronous_frames.size());
+
+            std::vector<double> streaming_frames;
+            for (size_t i = 0; i < 3; ++i)
+            {
+                auto loader = TextureLoader();
+                std::vector<std::shared_ptr<AsyncTexture>> textures;
+                for (size_t j = 0; j < n_textures; ++j)
+                    textures.push_back(loader.load(path));
+
+                while (loader.get_n_pending() > 0)
+                {
+                    auto before = clock::now();
+                    loader.update();
+                    glFinish();
+                    streaming_frames.push_back(std::chrono::duration<double, std::nano>(clock::now() - before).count());
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            bench.report("streaming/update_frame", size, streaming_frames, streaming_frames.size());
+            std::remove(path.c_str());
+        }
+    }
+
+    void bench_images(Bench& bench)
+    {
+        for (size_t size : {64, 256, 1024, 2048})
+        {
+            auto image = Image();
+            bench.run("image/create", size, [&](){ image.create(size, size, RGBA(0, 0, 0, 1)); });
+
+            bench.run("image/set_pixel", size, [&](){
+                for (size_t y = 0; y < size; ++y)
+                    for (size_t x = 0; x < size; ++x)
+                        image.set_pixel(x, y, RGBA(1, 0, 0, 1));
+            });
+
+            bench.run("image/get_pixel", size, [&](){
+                float sum = 0;
+                for (size_t y = 0; y < size; ++y)
+                    for (size_t x = 0; x < size; ++x)
+                        sum += image.get_pixel(x, y).r;
+                volatile float sink = sum;
+                (void) sink;
+            });
+
+            bench.run("image/copy", size, [&](){ auto out = Image(image); });
+            bench.run("image/copy_then_set_pixel", size, [&](){ auto out = Image(image); out.set_pixel(0, 0, RGBA(1, 1, 1, 1)); });
+            bench.run("image/view_to_image", size, [&](){ auto out = image.view(size / 4, size / 4, size / 2, size / 2).to_image(); });
+            bench.run("image/as_flipped", size, [&](){ auto out = image.as_flipped(true, true); });
+            bench.run("image/as_cropped", size, [&](){ auto out = image.as_cropped(size / 4, size / 4, size / 2, size / 2); });
+            bench.run("image/as_downsampled", size, [&](){ auto out = image.as_downsampled(); });
+            bench.run("image/as_scaled_nearest", size, [&](){ auto out = image.as_scaled(size / 3, size / 3, InterpolationType::NEAREST); });
+            bench.run("image/as_scaled_bilinear", size, [&](){ auto out = image.as_scaled(size / 3, size / 3, InterpolationType::BILINEAR); });
+            bench.run("image/as_scaled_bicubic", size, [&](){ auto out = image.as_scaled(size / 3, size / 3, InterpolationType::BICUBIC); });
+            bench.run("image/as_scaled_lanczos", size, [&](){ auto out = image.as_scaled(size / 3, size / 3, InterpolationType::LANCZOS); });
+            bench.run("image/as_scaled_upscale", size, [&](){ auto out = image.as_scaled(size * 3 / 2, size * 3 / 2, InterpolationType::BILINEAR); });
+        }
+
+        // 4k frame, against the per-pixel get_pixel / set_pixel loops the row kernels replaced
+
+        auto frame = Image();
+        frame.create(3840, 2160, RGBA(0.2, 0.4, 0.6, 1));
+
+        auto sprite = Image();
+        sprite.create(3840, 2160, RGBA(1, 0, 0, 0.5));
+
+        const size_t n = 3840 * 2160;
+        bench.run("image_4k/as_flipped_per_pixel", n, [&](){
+            auto out = Image();
+            out.create(3840, 2160, RGBA(0, 0, 0, 0));
+            for (size_t y = 0; y < 2160; ++y)
+                for (size_t x = 0; x < 3840; ++x)
+                    out.set_pixel(3840 - x - 1, 2160 - y - 1, frame.get_pixel(x, y));
+        });
+
+        bench.run("image_4k/as_flipped", n, [&](){ auto out = frame.as_flipped(true, true); });
+        bench.run("image_4k/as_flipped_vertically", n, [&](){ auto out = frame.as_flipped(false, true); });
+        bench.run("image_4k/as_cropped", n / 4, [&](){ auto out = frame.as_cropped(-960, -540, 1920, 1080); });
+        bench.run("image_4k/blit", n, [&](){ frame.blit(sprite.view(), {0, 0}); });
+        bench.run("image_4k/blit_alpha_blend", n, [&](){ frame.blit(sprite.view(), {0, 0}, true); });
+
+        bench.run("image_4k/blit_alpha_blend_per_pixel", n, [&](){
+            for (size_t y = 0; y < 2160; ++y)
+            {
+                for (size_t x = 0; x < 3840; ++x)
+                {
+                    auto s = sprite.get_pixel(x, y);
+                    auto d = frame.get_pixel(x, y);
+                    frame.set_pixel(x, y, RGBA(
+                        s.a * s.r + (1 - s.a) * d.r,
+                        s.a * s.g + (1 - s.a) * d.g,
+                        s.a * s.b + (1 - s.a) * d.b,
+                        s.a + (1 - s.a) * d.a
+                    ));
+                }
+            }
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options();
+    for (int i = 1; i < argc; ++i)
+    {
+        auto arg = std::string(argv[i]);
+        if (arg == "--filter" and i + 1 < argc)
+            options.filter = argv[++i];
+        else if (arg == "--min-time" and i + 1 < argc)
+            options.min_time = std::stod(argv[++i]);
+        else if (arg == "--output" and i + 1 < argc)
+            options.output = argv[++i];
+        else
+        {
+            std::cerr << "usage: mousetrap_bench [--filter <substring>] [--min-time <seconds>] [--output <path>]" << std::endl;
+            return 1;
+        }
+    }
+
+    auto context = create_offscreen_context();
+    if (context.empty())
+    {
+        std::cerr << "[ERROR] In mousetrap_bench: Unable to create an offscreen gl context" << std::endl;
+        return 1;
+    }
+
+    if (not initialize_glew())
+    {
+        std::cerr << "[ERROR] In mousetrap_bench: Unable to initialize glew" << std::endl;
+        return 1;
+    }
+
+    auto file = std::ofstream();
+    if (not options.output.empty())
+    {
+        file.open(options.output);
+        if (not file.is_open())
+        {
+            std::cerr << "[ERROR] In mousetrap_bench: Unable to open file at `" << options.output << "`" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    out << "{\"context\":\"" << context << "\""
+        << ",\"renderer\":\"" << glGetString(GL_RENDERER) << "\""
+        << ",\"version\":\"" << glGetString(GL_VERSION) << "\""
+        << "}" << std::endl;
+
+    const size_t target_size = 1024;
+    auto target = RenderTexture();
+    target.create(target_size, target_size);
+    target.bind_as_rendertarget();
+    glViewport(0, 0, target_size, target_size);
+
+    auto bench = Bench(options, out);
+    bench_shapes(bench);
+    bench_uploads(bench);
+    bench_draws(bench);
+    bench_uniforms(bench);
+    bench_textures(bench);
+    bench_images(bench);
+    bench_streaming(bench);
+
+    target.unbind_as_rendertarget();
+    return 0;
+}
@@ -0,0 +1,112 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <span>
+
+#include "shape.hpp"
+#include "shader.hpp"
+#include "gl_transform.hpp"
+#include "blend_mode.hpp"
+#include "texture_object.hpp"
+
+namespace mousetrap
+{
+    /// \brief records draw commands and their geometry without calling gl, so it can be filled on any thread
+    /// \note a list may only be used by one thread at a time, use one list per worker. Memory is kept across clear(), so a reused list stops allocating after the first frames
+    class CommandList
+    {
+        friend class CommandSubmitter;
+
+        public:
+            struct Vertex
+            {
+                Vector3f position;
+                RGBA color;
+                Vector2f texture_coordinates;
+            };
+
+            CommandList() = default;
+
+            /// \brief copy the current geometry of a shape in world space, the shape must not be modified while this runs
+            /// \param shader: nullptr for the noop shader
+            /// \param transform: nullptr for identity
+            void draw(const Shape&, Shader* = nullptr, const GLTransform* = nullptr, BlendMode = BlendMode::NORMAL, uint8_t layer = 0);
+
+            /// \brief record raw geometry in mousetrap coordinates, for building geometry off the gl thread
+            void draw(std::span<const Vertex>, std::span<const uint32_t> indices, GLenum render_type, const TextureObject* = nullptr, Shader* = nullptr, const GLTransform* = nullptr, BlendMode = BlendMode::NORMAL, uint8_t layer = 0);
+
+            void draw_rectangle(Vector2f top_left, Vector2f size, RGBA color, const TextureObject* = nullptr, Shader* = nullptr, const GLTransform* = nullptr, BlendMode = BlendMode::NORMAL, uint8_t layer = 0);
+
+            /// \brief remove all commands, keeps allocated memory
+            void clear();
+
+            size_t get_n_commands() const;
+
+        private:
+            struct Command
+            {
+                Shader* shader;
+                const TextureObject* texture;
+                GLTransform transform;
+                BlendMode blend_mode;
+                uint8_t layer;
+
+                // always GL_POINTS, GL_LINES or GL_TRIANGLES
+                GLenum render_type;
+
+                // ranges into the arena, indices are relative to vertex_begin
+                size_t vertex_begin, vertex_end;
+                size_t index_begin, index_end;
+            };
+
+            void push_command(GLenum render_type, const TextureObject*, Shader*, const GLTransform*, BlendMode, uint8_t layer, size_t vertex_begin, size_t index_begin);
+
+            // arena
+            std::vector<Vertex> _vertices;
+            std::vector<uint32_t> _indices;
+            std::vector<Command> _commands;
+    };
+
+    /// \brief merges command lists and submits them on the gl thread
+    /// commands are ordered by layer, then by the order of the lists passed to submit, then by recording order, independent of which thread finished first.
+    /// Consecutive commands with identical state are merged into one draw call
+    class CommandSubmitter
+    {
+        public:
+            struct Statistics
+            {
+                size_t n_commands = 0;
+                size_t n_draw_calls = 0;
+            };
+
+            CommandSubmitter();
+            ~CommandSubmitter();
+
+            /// \brief render all commands, lists are not cleared. Has to be called on the gl thread after all recording threads finished
+            void submit(const std::vector<const CommandList*>&);
+
+            /// \brief statistics of the last submit
+            Statistics get_statistics() const;
+
+        private:
+            class Batch;
+            std::vector<std::unique_ptr<Batch>> _batches;
+
+            struct Entry
+            {
+                const CommandList* list;
+                const CommandList::Command* command;
+            };
+
+            std::vector<Entry> _entries;
+            Statistics _statistics;
+
+            static inline Shader* noop_shader = nullptr;
+    };
+}
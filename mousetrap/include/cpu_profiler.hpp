@@ -0,0 +1,93 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/// \brief zones are compiled out unless the library is built with -DMOUSETRAP_ENABLE_PROFILING=ON
+#ifdef MOUSETRAP_ENABLE_PROFILING
+    #define MOUSETRAP_PROFILE_CONCAT_IMPL(a, b) a##b
+    #define MOUSETRAP_PROFILE_CONCAT(a, b) MOUSETRAP_PROFILE_CONCAT_IMPL(a, b)
+
+    /// \param name: string literal, only the pointer is stored
+    #define MOUSETRAP_PROFILE_ZONE(name) mousetrap::CPUProfiler::Zone MOUSETRAP_PROFILE_CONCAT(_mousetrap_profile_zone_, __LINE__)(name)
+#else
+    #define MOUSETRAP_PROFILE_ZONE(name)
+#endif
+
+namespace mousetrap
+{
+    /// \brief records the cpu time of scoped zones on all threads, c.f. MOUSETRAP_PROFILE_ZONE
+    /// each thread writes to its own fixed-size buffer without locking, events past the capacity of a buffer are dropped
+    class CPUProfiler
+    {
+        public:
+            /// \brief measures from construction to destruction
+            class Zone
+            {
+                public:
+                    Zone(const char* name);
+                    ~Zone();
+
+                    Zone(const Zone&) = delete;
+                    Zone& operator=(const Zone&) = delete;
+
+                private:
+                    const char* _name;
+                    uint64_t _begin;
+            };
+
+            /// \brief enabled by default in profiling builds
+            static void set_enabled(bool);
+            static bool get_enabled();
+
+            /// \brief write all recorded events as chrome trace event json, viewable in chrome://tracing or perfetto
+            static bool write_chrome_trace(const std::string& path);
+            static std::string to_chrome_trace();
+
+            /// \brief discard all events, no zones may be open on other threads while this runs
+            static void clear();
+
+            static size_t get_n_dropped_events();
+
+            /// \brief nanoseconds since an unspecified epoch, monotonic
+            static uint64_t now();
+
+        private:
+            static constexpr size_t events_per_thread = 1 << 16;
+
+            struct Event
+            {
+                const char* name;
+                uint64_t begin;
+                uint64_t end;
+            };
+
+            struct ThreadBuffer
+            {
+                size_t thread_id;
+                std::unique_ptr<Event[]> events = std::unique_ptr<Event[]>(new Event[events_per_thread]);
+
+                // written by owning thread only, release on write, acquire on export
+                std::atomic<size_t> n_events = 0;
+                std::atomic<size_t> n_dropped = 0;
+            };
+
+            static ThreadBuffer& get_thread_buffer();
+            static void push(const char* name, uint64_t begin, uint64_t end);
+
+            static inline std::atomic<bool> _enabled = true;
+
+            // only locked when a thread records its first event and on export
+            static inline std::mutex _buffers_lock;
+            static inline std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+    };
+}
@@ -24,4 +24,73 @@ namespace mousetrap
 
     Vector3f to_gl_position(Vector3f);
     Vector3f from_gl_position(Vector3f);
+
+    /// \brief matrix equivalent of to_gl_position, maps [0, 1] top-left origin coordinates to gl coordinates
+    glm::mat4 get_gl_projection();
+
+    /// \brief shadows bound gl state of the current context, calls that would not change state are skipped
+    /// all mousetrap classes route through the cache, call invalidate() after modifying gl state directly
+    class GLStateCache
+    {
+        public:
+            struct Statistics
+            {
+                size_t n_issued = 0;
+                size_t n_skipped = 0;
+            };
+
+            static void use_program(GLNativeHandle);
+            static void bind_vertex_array(GLNativeHandle);
+            static void bind_texture(size_t texture_unit, GLNativeHandle);
+            static void bind_framebuffer(GLNativeHandle);
+            static GLNativeHandle get_framebuffer();
+            static void bind_uniform_buffer(size_t binding_point, GLNativeHandle);
+
+            static void set_blend_enabled(bool);
+            static void set_blend_equation(GLenum rgb, GLenum alpha);
+            static void set_blend_function(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha);
+
+            /// \brief forget bindings of a deleted object, gl may reuse its id
+            static void on_program_deleted(GLNativeHandle);
+            static void on_vertex_array_deleted(GLNativeHandle);
+            static void on_texture_deleted(GLNativeHandle);
+            static void on_framebuffer_deleted(GLNativeHandle);
+            static void on_buffer_deleted(GLNativeHandle);
+
+            /// \brief mark all state as unknown, the next call of each kind will be issued
+            static void invalidate();
+
+            static Statistics get_statistics();
+            static void reset_statistics();
+
+        private:
+            static constexpr size_t n_texture_units = 16;
+            static constexpr size_t n_uniform_buffer_bindings = 36;
+            static constexpr GLNativeHandle unknown = GLNativeHandle(-1);
+
+            static bool should_issue(bool changed);
+
+            static inline GLNativeHandle _program = unknown;
+            static inline GLNativeHandle _vertex_array = unknown;
+            static inline GLNativeHandle _framebuffer = unknown;
+
+            static inline GLenum _active_texture_unit = unknown;
+            static inline std::array<GLNativeHandle, n_texture_units> _textures = [](){
+                std::array<GLNativeHandle, n_texture_units> out;
+                out.fill(unknown);
+                return out;
+            }();
+
+            static inline std::array<GLNativeHandle, n_uniform_buffer_bindings> _uniform_buffers = [](){
+                std::array<GLNativeHandle, n_uniform_buffer_bindings> out;
+                out.fill(unknown);
+                return out;
+            }();
+
+            static inline int _blend_enabled = -1;
+            static inline std::array<GLenum, 2> _blend_equation = {unknown, unknown};
+            static inline std::array<GLenum, 4> _blend_function = {unknown, unknown, unknown, unknown};
+
+            static inline Statistics _statistics;
+    };
 }
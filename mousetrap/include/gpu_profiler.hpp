@@ -0,0 +1,88 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <unordered_map>
+
+#include "gl_common.hpp"
+
+namespace mousetrap
+{
+    /// \brief measures gpu time of named zones, e.g. render tasks or render texture passes, using gl timestamp queries
+    /// results are read back a few frames later, so measuring never stalls the pipeline. Disabled by default, all calls are noops while disabled
+    class GPUProfiler
+    {
+        public:
+            /// \brief all values in milliseconds, over the last frames in the history
+            struct Timing
+            {
+                std::string name;
+                float min = 0;
+                float average = 0;
+                float p99 = 0;
+                size_t n_frames = 0;
+            };
+
+            /// \brief requires GL_ARB_timer_query, core since gl 3.3 and supported by mesa llvmpipe
+            static void set_enabled(bool);
+            static bool get_enabled();
+
+            /// \brief brackets one frame, zones are only recorded in between. The whole frame is reported as zone `frame`
+            static void begin_frame();
+            static void end_frame();
+
+            /// \brief zones may nest, time of zones with the same name is summed per frame
+            static void begin_zone(const std::string& name);
+            static void end_zone();
+
+            static std::vector<Timing> get_timings();
+
+            /// \brief number of frames whose results were not available in time and were discarded
+            static size_t get_n_dropped_frames();
+
+            /// \brief clear history and release all queries
+            static void reset();
+
+        private:
+            static constexpr size_t n_frames_in_flight = 4;
+            static constexpr size_t history_size = 256;
+
+            struct Sample
+            {
+                size_t name_id;
+                size_t begin_query;
+                size_t end_query;
+            };
+
+            struct Frame
+            {
+                std::vector<GLNativeHandle> queries;
+                size_t n_queries_used = 0;
+                std::vector<Sample> samples;
+                bool pending = false;
+            };
+
+            static size_t get_name_id(const std::string&);
+            static size_t issue_timestamp(Frame&);
+            static void collect(Frame&);
+
+            static inline bool _enabled = false;
+            static inline bool _in_frame = false;
+
+            static inline std::array<Frame, n_frames_in_flight> _frames;
+            static inline size_t _current_frame = 0;
+            static inline std::vector<size_t> _open_zones;
+
+            static inline std::vector<std::string> _names;
+            static inline std::unordered_map<std::string, size_t> _name_to_id;
+            static inline std::vector<std::deque<float>> _history;
+
+            static inline size_t _n_dropped_frames = 0;
+    };
+}
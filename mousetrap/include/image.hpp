@@ -10,9 +10,33 @@
 
 #include <gtk/gtk.h>
 #include <vector>
+#include <memory>
+#include <cstdint>
 
 namespace mousetrap
 {
+    /// \brief memory layout of one pixel, all formats have 4 channels in rgba order
+    enum class ImageFormat
+    {
+        RGBA8,      // 1 byte per channel, normalized
+        RGBA16F,    // half float per channel
+        RGBA32F     // float per channel
+    };
+
+    size_t get_bytes_per_pixel(ImageFormat);
+
+    /// \brief filter used by Image::as_scaled
+    enum class InterpolationType
+    {
+        NEAREST,
+        BILINEAR,
+        BICUBIC,    // catmull-rom
+        LANCZOS     // lanczos-3, sharpest, may ring near hard edges
+    };
+
+    class ImageView;
+
+    /// \brief copies share their pixel buffer until one of them is modified
     class Image
     {
         public:
@@ -23,23 +47,56 @@ namespace mousetrap
             Image& operator=(const Image&);
             Image& operator=(Image&&);
 
-            void create(size_t width, size_t height, RGBA default_color = RGBA(0, 0, 0, 1));
+            void create(size_t width, size_t height, RGBA default_color = RGBA(0, 0, 0, 1), ImageFormat = ImageFormat::RGBA8);
             bool create_from_file(const std::string&);
             void create_from_pixbuf(GdkPixbuf*);
             void create_from_texture(GdkTexture*);
 
             bool save_to_file(const std::string&) const;
 
-            void* data() const;
+            /// \brief raw pixel data, rows are tightly packed, layout depends on get_format
+            /// \note the non-const overload copies the buffer first if it is shared with another image
+            void* data();
+            const void* data() const;
+
+            /// \brief whether the pixel buffer is currently shared with a copy of this image
+            bool is_shared() const;
+
+            /// \brief size of data in bytes
             size_t get_data_size() const;
             size_t get_n_pixels() const;
             GdkPixbuf* to_pixbuf() const;
             Vector2ui get_size() const;
 
-            Image as_scaled(size_t size_x, size_t size_y, TextureScale type) const;
+            ImageFormat get_format() const;
+
+            /// \brief copy with pixels converted to another format, values are clamped to [0, 1] when converting to RGBA8
+            Image as_format(ImageFormat) const;
+
+            /// \brief separable resampler working in the images format, filters are widened when downscaling to avoid aliasing
+            Image as_scaled(size_t size_x, size_t size_y, InterpolationType = InterpolationType::BILINEAR) const;
+
+            /// \brief maps to the closest InterpolationType, GDK_INTERP_HYPER uses BICUBIC
+            Image as_scaled(size_t size_x, size_t size_y, GdkInterpType) const;
             Image as_cropped(int offset_x, int offset_y, size_t new_width, size_t new_height) const;
+
+            /// \brief copy the source to position, clipped to the bounds of this image, source is converted if its format differs
+            /// \param alpha_blend: composite with the same equation as BlendMode::NORMAL instead of replacing pixels
+            /// \note source may not overlap this image
+            void blit(const ImageView& source, Vector2i position, bool alpha_blend = false);
+
+            /// \brief non-owning view of a sub-rectangle, clamped to the image bounds, invalidated when this image is modified or destroyed
+            ImageView view(size_t offset_x, size_t offset_y, size_t width, size_t height) const;
+            ImageView view() const;
             Image as_flipped(bool flip_horizontally, bool flip_vertically) const;
 
+            /// \brief half size in each dimension, 2x2 box filter, odd sizes clamp the last row and column
+            Image as_downsampled() const;
+
+            /// \brief this image followed by successive downsamples down to 1x1, c.f. Texture::create_from_mipmap_chain
+            std::vector<Image> create_mipmap_chain() const;
+
+            /// \brief converts from and to the pixel format on access
             void set_pixel(size_t, size_t, RGBA);
             void set_pixel(size_t, size_t, HSVA);
             RGBA get_pixel(size_t, size_t) const;
@@ -49,9 +106,51 @@ namespace mousetrap
             RGBA get_pixel(size_t linear_index) const;
 
         private:
-            Vector2i _size;
-            std::vector<uint8_t> _data;
+            friend class ImageView;
+
+            Vector2i _size = {0, 0};
+            ImageFormat _format = ImageFormat::RGBA8;
+            std::shared_ptr<std::vector<uint8_t>> _data;
+
+            void allocate(size_t n_bytes);
+            void detach();
+
+            uint8_t* bytes();
+            const uint8_t* bytes() const;
 
             size_t to_linear_index(size_t, size_t) const;
+
+            void write_pixel(size_t byte_index, RGBA);
+            RGBA read_pixel(size_t byte_index) const;
+    };
+
+    /// \brief read-only sub-rectangle of an image, rows are not contiguous, c.f. get_row_stride
+    class ImageView
+    {
+        public:
+            ImageView() = default;
+
+            Vector2ui get_size() const;
+            ImageFormat get_format() const;
+
+            /// \brief distance between the start of two rows, in bytes
+            size_t get_row_stride() const;
+            const void* get_row(size_t y) const;
+
+            RGBA get_pixel(size_t x, size_t y) const;
+
+            /// \brief sub-rectangle relative to this view, clamped to its bounds
+            ImageView view(size_t offset_x, size_t offset_y, size_t width, size_t height) const;
+
+            /// \brief copy the viewed pixels into a new image
+            Image to_image() const;
+
+        private:
+            friend class Image;
+
+            const uint8_t* _data = nullptr;
+            size_t _row_stride = 0;
+            Vector2ui _size = {0, 0};
+            ImageFormat _format = ImageFormat::RGBA8;
     };
 }
@@ -0,0 +1,58 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <vector>
+
+#include "gl_common.hpp"
+#include "gl_transform.hpp"
+#include "colors.hpp"
+
+namespace mousetrap
+{
+    class Shape;
+
+    /// \brief per-instance transform and tint, used to draw many copies of one shape in a single instanced draw call
+    class InstanceBuffer
+    {
+        friend class Shape;
+
+        public:
+            InstanceBuffer();
+            ~InstanceBuffer();
+
+            InstanceBuffer(const InstanceBuffer&) = delete;
+            InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+            /// \brief allocate n instances with identity transform and white tint
+            void create(size_t n_instances);
+            size_t get_n_instances() const;
+
+            /// \param transform: operates in gl coordinate system, only the 2d affine part is used
+            void set_instance(size_t, GLTransform transform, RGBA tint = RGBA(1, 1, 1, 1));
+
+            void set_instance_transform(size_t, GLTransform);
+            void set_instance_color(size_t, RGBA);
+            RGBA get_instance_color(size_t) const;
+
+        private:
+            struct InstanceInfo
+            {
+                float _transform_row_0[3];
+                float _transform_row_1[3];
+                float _color[4];
+            };
+
+            void mark_dirty(size_t first_instance, size_t past_last_instance);
+            void update_data();
+
+            std::vector<InstanceInfo> _instance_data;
+            size_t _dirty_begin = 0,
+            _dirty_end = 0;
+
+            bool _reallocate = false;
+            GLNativeHandle _buffer_id = 0;
+    };
+}
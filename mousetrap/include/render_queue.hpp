@@ -0,0 +1,61 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "render_task.hpp"
+
+namespace mousetrap
+{
+    /// \brief collects render tasks for one frame, sorts them by state and submits them with only the necessary state changes
+    class RenderQueue
+    {
+        public:
+            struct Statistics
+            {
+                /// \brief tasks that were drawn, tasks without a shape or with an invisible shape are not counted
+                size_t n_tasks = 0;
+                size_t n_program_changes = 0;
+                size_t n_texture_changes = 0;
+                size_t n_blend_mode_changes = 0;
+
+                /// \brief compared to submitting the tasks in the order they were pushed
+                size_t n_state_changes_saved = 0;
+            };
+
+            RenderQueue() = default;
+
+            /// \param layer: lower layers are drawn first, order of tasks is only guaranteed across layers
+            /// \param depth: in [0, 1], tie breaker after shader, texture and blend mode
+            void push(RenderTask*, uint8_t layer = 0, float depth = 0);
+            void clear();
+
+            /// \brief sort and render all tasks, then clear the queue
+            void submit();
+
+            /// \brief statistics of the last submit
+            Statistics get_statistics() const;
+
+        private:
+            static uint64_t compute_key(RenderTask*, uint8_t layer, float depth);
+            void sort();
+
+            struct Entry
+            {
+                uint64_t key;
+                RenderTask* task;
+            };
+
+            /// \brief program, texture and blend mode transitions when submitting entries in this order
+            static size_t count_state_changes(const std::vector<Entry>&);
+
+            std::vector<Entry> _entries;
+            std::vector<Entry> _swap;
+
+            Statistics _statistics;
+    };
+}
@@ -9,13 +9,19 @@
 #include "shader.hpp"
 #include "gl_transform.hpp"
 #include "blend_mode.hpp"
+#include "uniform_buffer.hpp"
+#include "gpu_profiler.hpp"
 
-#include <map>
+#include <vector>
 
 namespace mousetrap
 {
+    class RenderQueue;
+
     class RenderTask
     {
+        friend class RenderQueue;
+
         public:
             RenderTask(Shape*, Shader* = nullptr, GLTransform* = nullptr, BlendMode blend_mode = BlendMode::NORMAL);
 
@@ -39,30 +45,66 @@ namespace mousetrap
             void register_color(const std::string& uniform_name, const RGBA*);
             void register_color(const std::string& uniform_name, const HSVA* will_not_be_converted);
 
+            /// \brief bind buffer to the uniform block of the shader, the buffer is shared, its data is uploaded once per change, not per task
+            void register_uniform_buffer(const std::string& block_name, UniformBufferObject*);
+
             void render();
 
+            /// \brief render the shape once per instance, if no shader was specified the instanced noop shader is used
+            void set_instances(InstanceBuffer*);
+            InstanceBuffer* get_instances();
+
             Shape* get_shape();
             Shader* get_shader();
             GLTransform* get_transform();
+            BlendMode get_blend_mode() const;
+
+            /// \brief gpu time of render() is reported under this name while GPUProfiler is enabled, empty for no zone
+            void set_profiling_name(const std::string&);
+            const std::string& get_profiling_name() const;
 
         private:
+            void set_registered_uniforms(Shader&);
+
+            enum class UniformType
+            {
+                FLOAT,
+                INT,
+                UINT,
+                VEC2,
+                VEC3,
+                VEC4,
+                TRANSFORM,
+                COLOR_RGBA,
+                COLOR_HSVA,
+                BLOCK
+            };
+
+            /// \brief location is resolved once per program, not on every render, for blocks it is the block index
+            struct UniformBinding
+            {
+                std::string name;
+                UniformType type;
+                const void* value;
+                int location = -1;
+            };
+
+            void add_binding(const std::string& uniform_name, UniformType, const void*);
+            void resolve_uniform_locations(Shader&);
+
+            std::vector<UniformBinding> _uniforms;
+            GLNativeHandle _resolved_program_id = 0;
+
             Shape* _shape = nullptr;
             Shader* _shader = nullptr;
             GLTransform* _transform = nullptr;
             BlendMode _blend_mode;
+            InstanceBuffer* _instances = nullptr;
+            std::string _profiling_name;
 
             static inline Shader* noop_shader = nullptr;
+            static inline Shader* noop_instanced_shader = nullptr;
             static inline GLTransform* noop_transform = nullptr;
-
-            std::map<std::string, const float*> _floats;
-            std::map<std::string, const int*> _ints;
-            std::map<std::string, const glm::uint*> _uints;
-            std::map<std::string, const Vector2f*> _vec2s;
-            std::map<std::string, const Vector3f*> _vec3s;
-            std::map<std::string, const Vector4f*> _vec4s;
-            std::map<std::string, const GLTransform*> _transforms;
-            std::map<std::string, const RGBA*> _colors_rgba;
-            std::map<std::string, const HSVA*> _colors_hsva;
     };
 }
 
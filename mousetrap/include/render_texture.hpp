@@ -5,9 +5,11 @@
 #pragma once
 
 #include "texture.hpp"
+#include "gpu_profiler.hpp"
 
 namespace mousetrap
 {
+    /// \brief texture that can be rendered into, allocate with Texture::create, whose format argument selects the render target format
     class RenderTexture : public Texture
     {
         public:
@@ -23,9 +25,13 @@ namespace mousetrap
             void bind_as_rendertarget() const;
             void unbind_as_rendertarget() const;
 
+            /// \brief gpu time between bind_as_rendertarget and unbind_as_rendertarget is reported under this name while GPUProfiler is enabled
+            void set_profiling_name(const std::string&);
+
         protected:
             GLNativeHandle _framebuffer_handle;
             mutable GLint _before_buffer = 0;
+            std::string _profiling_name;
     };
 }
 
@@ -11,6 +11,17 @@ namespace mousetrap
     enum class ScaleMode
     {
         NEAREST = GL_NEAREST,
-        LINEAR = GL_LINEAR
+        LINEAR = GL_LINEAR,
+
+        // require mipmaps, generated on bind if the texture has none
+        NEAREST_MIPMAP = GL_NEAREST_MIPMAP_NEAREST,
+        LINEAR_MIPMAP = GL_LINEAR_MIPMAP_NEAREST,
+        TRILINEAR = GL_LINEAR_MIPMAP_LINEAR,
+        ANISOTROPIC = -1    // trilinear with the maximum anisotropy supported, trilinear if anisotropic filtering is unavailable
     };
+
+    inline bool scale_mode_uses_mipmaps(ScaleMode mode)
+    {
+        return mode != ScaleMode::NEAREST and mode != ScaleMode::LINEAR;
+    }
 }
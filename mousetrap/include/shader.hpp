@@ -12,6 +12,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "gl_common.hpp"
 #include "gl_transform.hpp"
 
@@ -33,13 +34,18 @@ namespace mousetrap
             GLNativeHandle get_fragment_shader_id() const;
             GLNativeHandle get_vertex_shader_id() const;
 
-            //
+            /// \brief vertex shaders should `#include <mousetrap>` and use `to_gl_position`, vertex positions are in mousetrap coordinates
             void create_from_string(const std::string& code, ShaderType);
             void create_from_file(const std::string& path, ShaderType);
 
             //
             int get_uniform_location(const std::string&) const;
 
+            /// \brief locations of uniforms set by Shape, resolved once after linking
+            int get_transform_location() const;
+            int get_projection_location() const;
+            int get_texture_set_location() const;
+
             //
             void set_uniform_float(const std::string& uniform_name, float);
             void set_uniform_int(const std::string& uniform_name, int);
@@ -49,14 +55,44 @@ namespace mousetrap
             void set_uniform_vec4(const std::string& uniform_name, Vector4f);
             void set_uniform_transform(const std::string& uniform_name, GLTransform);
 
+            /// \brief set by location, skips the name lookup, c.f. get_uniform_location
+            void set_uniform_float(int location, float);
+            void set_uniform_int(int location, int);
+            void set_uniform_uint(int location, glm::uint);
+            void set_uniform_vec2(int location, Vector2f);
+            void set_uniform_vec3(int location, Vector3f);
+            void set_uniform_vec4(int location, Vector4f);
+            void set_uniform_transform(int location, const GLTransform&);
+
+            /// \brief index of a uniform block, -1 if the program has no active block with that name
+            int get_uniform_block_index(const std::string& block_name) const;
+
+            /// \brief connect a uniform block to a uniform buffer binding point, c.f. UniformBufferObject
+            void bind_uniform_block(int block_index, size_t binding_point);
+            void bind_uniform_block(const std::string& block_name, size_t binding_point);
+
             //
             static int get_vertex_position_location();
             static int get_vertex_color_location();
             static int get_vertex_texture_coordinate_location();
 
+            /// \brief first of two consecutive locations, holding the rows of the 2d affine instance transform
+            static int get_instance_transform_location();
+            static int get_instance_color_location();
+
+            static const std::string& get_noop_instanced_vertex_shader_source();
+
         private:
             [[nodiscard]] GLNativeHandle compile_shader(const std::string&, ShaderType shader_type);
             [[nodiscard]] GLNativeHandle link_program(GLNativeHandle fragment_id, GLNativeHandle vertex_id);
+            void update_builtin_uniform_locations();
+
+            int _transform_location = -1,
+            _projection_location = -1,
+            _texture_set_location = -1;
+
+            // binding point per block index, block bindings are program state
+            std::vector<size_t> _uniform_block_bindings;
 
             // local
             GLNativeHandle _program_id,
@@ -89,6 +125,22 @@ namespace mousetrap
                 }
             )";
 
+            /// \brief replaces the first `#include <mousetrap>` with the shared vertex shader declarations, removes all others
+            static std::string resolve_includes(const std::string&);
+
+            static inline const std::string _include_directive = "#include <mousetrap>";
+
+            static inline const std::string _include_source = R"(
+                uniform mat4 _transform;
+                uniform mat4 _projection;
+
+                // maps mousetrap coordinates ([0, 1], origin top left) to gl coordinates, then applies the render transform
+                vec4 to_gl_position(vec3 position)
+                {
+                    return _transform * _projection * vec4(position, 1.0);
+                }
+            )";
+
             static inline const std::string _noop_vertex_shader_source = R"(
                 #version 330
 
@@ -96,7 +148,7 @@ namespace mousetrap
                 layout (location = 1) in vec4 _vertex_color_in;
                 layout (location = 2) in vec2 _vertex_texture_coordinates_in;
 
-                uniform mat4 _transform;
+                #include <mousetrap>
 
                 out vec4 _vertex_color;
                 out vec2 _texture_coordinates;
@@ -104,12 +156,48 @@ namespace mousetrap
 
                 void main()
                 {
-                    gl_Position = _transform * vec4(_vertex_position_in, 1.0);
+                    gl_Position = to_gl_position(_vertex_position_in);
                     _vertex_color = _vertex_color_in;
                     _vertex_position = _vertex_position_in;
                     _texture_coordinates = _vertex_texture_coordinates_in;
                 }
             )";
+
+            static inline const std::string _noop_instanced_vertex_shader_source = R"(
+                #version 330
+
+                layout (location = 0) in vec3 _vertex_position_in;
+                layout (location = 1) in vec4 _vertex_color_in;
+                layout (location = 2) in vec2 _vertex_texture_coordinates_in;
+                layout (location = 3) in vec3 _instance_transform_row_0_in;
+                layout (location = 4) in vec3 _instance_transform_row_1_in;
+                layout (location = 5) in vec4 _instance_color_in;
+
+                #include <mousetrap>
+
+                out vec4 _vertex_color;
+                out vec2 _texture_coordinates;
+                out vec3 _vertex_position;
+
+                void main()
+                {
+                    // instance transforms operate in gl coordinates, after projection
+
+                    vec4 projected = _projection * vec4(_vertex_position_in, 1.0);
+                    vec3 xy1 = vec3(projected.xy, 1.0);
+                    vec4 position = vec4(
+                        dot(_instance_transform_row_0_in, xy1),
+                        dot(_instance_transform_row_1_in, xy1),
+                        projected.z,
+                        1.0
+                    );
+
+                    gl_Position = _transform * position;
+                    _vertex_color = _vertex_color_in * _instance_color_in;
+                    _vertex_position = _vertex_position_in;
+                    _texture_coordinates = _vertex_texture_coordinates_in;
+                }
+            )";
     };
 }
 
@@ -15,6 +15,7 @@
 #include <string>
 #include <algorithm>
 #include <mutex>
+#include <span>
 
 #include "gl_common.hpp"
 #include "shader.hpp"
@@ -22,15 +23,25 @@
 #include "gl_transform.hpp"
 #include "texture.hpp"
 #include "geometry.hpp"
+#include "instance_buffer.hpp"
+#include "vertex_format.hpp"
 
 namespace mousetrap
 {
+    class ShapeBatch;
+    class RenderQueue;
+    class CommandList;
+
     //
     class Shape
     {
+        friend class ShapeBatch;
+        friend class RenderQueue;
+        friend class CommandList;
+
         public:
             Shape();
-            ~Shape();
+            virtual ~Shape();
 
             void as_point(Vector2f);
             void as_points(const std::vector<Vector2f>&);
@@ -49,19 +60,33 @@ namespace mousetrap
             void as_wireframe(const std::vector<Vector2f>&);
             void as_wireframe(const Shape&);
 
-            void render(Shader& shader, GLTransform transform);
+            virtual void render(Shader& shader, GLTransform transform);
+
+            /// \brief draw one copy of the shape per instance in a single draw call, requires a shader using the instance attributes, c.f. Shader::get_noop_instanced_vertex_shader_source
+            void render_instanced(Shader& shader, GLTransform transform, InstanceBuffer& instances);
 
             RGBA get_vertex_color(size_t) const;
             void set_vertex_color(size_t, RGBA);
+            void set_vertex_colors(size_t first_vertex, std::span<const RGBA>);
 
             void set_vertex_texture_coordinate(size_t, Vector2f);
+            void set_vertex_texture_coordinates(size_t first_vertex, std::span<const Vector2f>);
             Vector2f get_vertex_texture_coordinate(size_t) const;
 
             void set_vertex_position(size_t, Vector3f);
+            void set_vertex_positions(size_t first_vertex, std::span<const Vector3f>);
             Vector3f get_vertex_position(size_t) const;
 
+            /// \brief defer vertex uploads until the matching commit_edit, all changes in between are sent as one upload
+            void begin_edit();
+            void commit_edit();
+
             size_t get_n_vertices() const;
 
+            /// \brief memory layout of the vertex buffer, changing it reuploads all vertices
+            void set_vertex_format(VertexFormat);
+            VertexFormat get_vertex_format() const;
+
             void set_color(RGBA);
 
             void set_visible(bool);
@@ -76,7 +101,13 @@ namespace mousetrap
             void set_top_left(Vector2f);
             Vector2f get_top_left() const;
 
+            /// \brief move, rotate and scale only update the model transform, vertices are not touched
+            void translate(Vector2f);
             void rotate(Angle);
+            void scale(float x_factor, float y_factor);
+
+            /// \brief transform from local vertex positions to world space, operates in mousetrap coordinate system
+            GLTransform get_model_transform() const;
 
             void set_texture(const TextureObject*);
             const TextureObject* get_texture();
@@ -97,34 +128,67 @@ namespace mousetrap
             bool _visible = true;
 
             std::vector<Vertex> _vertices;
-            std::vector<int> _indices;
+            std::vector<uint32_t> _indices;
             GLenum _render_type = GL_TRIANGLE_STRIP;
 
+            void update_indices();
             void update_position();
             void update_color();
             void update_texture_coordinate();
-            void initialize();
+
+            /// \brief upload new geometry and reset model transform, called by all as_* functions
+            virtual void initialize();
+            void upload_vertices();
+
+            void reset_model_transform();
+            Vector3f to_world_position(Vector3f local) const;
+            Vector3f to_local_position(Vector3f world) const;
 
             std::vector<Vector2f> sort_by_angle(const std::vector<Vector2f>&);
 
+            /// \brief upload pending data, set per-shape uniforms and draw, expects program and texture to already be bound
+            void draw(Shader& shader, GLTransform transform);
+            void draw_instanced(Shader& shader, GLTransform transform, InstanceBuffer& instances);
+
+            /// \brief called before each draw and before pending data is flushed, for subclasses that build their geometry lazily
+            virtual void update_geometry();
+
+            /// \brief resize vertex data to the current number of vertices and write vertices starting at first_vertex, does not upload
+            void write_vertex_data(size_t first_vertex);
+
         private:
-            struct VertexInfo
-            {
-                float _position[3];
-                float _color[4];
-                float _texture_coordinates[2];
-            };
+            VertexFormat _vertex_format = VertexFormat::DEFAULT;
+            size_t get_vertex_stride() const;
+            void update_vertex_layout();
+
+            void write_vertex_position(size_t);
+            void write_vertex_color(size_t);
+            void write_vertex_texture_coordinate(size_t);
+            void set_draw_uniforms(Shader&, GLTransform&);
 
-            void update_data(
-            bool update_position = true,
-            bool update_color = true,
-            bool update_tex_coords = true
-            );
+            /// \brief upload the dirty range of _vertex_data, noop if nothing changed since the last upload
+            void update_data();
+            void flush_data();
+            void mark_dirty(size_t first_vertex, size_t past_last_vertex);
 
-            std::vector<VertexInfo> _vertex_data;
+            std::vector<uint8_t> _vertex_data;
+            size_t _dirty_begin = 0,
+            _dirty_end = 0;
+
+            size_t _n_open_edits = 0;
+
+            glm::mat4 _model = glm::mat4(1);
+            bool _model_is_identity = true;
+
+            mutable Rectangle _bounding_box;
+            mutable bool _bounding_box_valid = false;
 
             GLNativeHandle _vertex_array_id = 0,
-            _vertex_buffer_id = 0;
+            _vertex_buffer_id = 0,
+            _element_buffer_id = 0;
+
+            GLenum _index_type = GL_UNSIGNED_INT;
+            size_t _n_indices = 0;
 
             const TextureObject* _texture = nullptr;
     };
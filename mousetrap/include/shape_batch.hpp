@@ -0,0 +1,52 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include "shape.hpp"
+
+namespace mousetrap
+{
+    /// \brief merges many shapes sharing the same shader, texture and blend mode into one vertex buffer, rendered with a single draw call
+    class ShapeBatch : public Shape
+    {
+        public:
+            ShapeBatch();
+
+            /// \brief append the current geometry of a shape, invisible shapes are skipped
+            void add(const Shape&);
+            void add(const std::vector<const Shape*>&);
+            void clear();
+
+            size_t get_n_shapes() const;
+
+            /// \brief GL_POINTS, GL_LINES or GL_TRIANGLES, the primitive a render type is converted to when batched, GL_NONE if it can't be batched
+            static GLenum get_independent_render_type(GLenum render_type);
+
+            /// \brief convert strips, fans and loops to independent primitives and append them to out, offset is added to each index
+            static void append_independent_indices(GLenum render_type, std::span<const uint32_t> in, uint32_t offset, std::vector<uint32_t>& out);
+
+        protected:
+            void update_geometry() override;
+
+            /// \brief as_* replaced the geometry, the batch now holds exactly that one shape
+            void initialize() override;
+
+        private:
+            enum class PrimitiveClass
+            {
+                NONE,
+                POINTS,
+                LINES,
+                TRIANGLES
+            };
+
+            static PrimitiveClass get_primitive_class(GLenum render_type);
+            void append(const Shape&);
+
+            PrimitiveClass _primitive_class = PrimitiveClass::NONE;
+            size_t _n_shapes = 0;
+            bool _batch_changed = false;
+    };
+}
@@ -11,11 +11,17 @@
 #include "texture_object.hpp"
 #include "wrap_mode.hpp"
 #include "scale_mode.hpp"
+#include "texture_format.hpp"
+
+#include <map>
+#include <vector>
 
 namespace mousetrap
 {
     class Texture : public TextureObject
     {
+        friend class TextureReadback;
+
         public:
             Texture(); // should be called while gl context is bound
             virtual ~Texture();
@@ -26,6 +32,7 @@ namespace mousetrap
             Texture(Texture&&);
             Texture& operator=(Texture&&);
 
+            /// \brief blocks until the gpu finished writing to the texture, c.f. TextureReadback
             [[nodiscard]] Image download() const;
 
             void bind(size_t texture_unit) const;
@@ -33,10 +40,28 @@ namespace mousetrap
             void bind() const override;
             void unbind() const override;
 
-            void create(size_t width, size_t height);
+            void create(size_t width, size_t height, TextureFormat = TextureFormat::RGBA16F);
             void create_from_file(const std::string& path);
+
+            /// \brief format matching the images format, RGBA8 for RGBA8 images
             void create_from_image(const Image&);
 
+            /// \brief image is converted on the cpu, so the driver receives data in the client format matching the texture format
+            void create_from_image(const Image&, TextureFormat);
+
+            /// \brief upload a prebaked chain, level i has to be the base size divided by 2^i, c.f. Image::create_mipmap_chain
+            void create_from_mipmap_chain(const std::vector<Image>& levels, TextureFormat = TextureFormat::RGBA8);
+
+            TextureFormat get_format() const;
+
+            /// \brief generate all levels from the base level on the gpu, has to be called again after the base level was modified
+            void generate_mipmaps();
+            bool has_mipmaps() const;
+
+            /// \brief offset added to the mipmap level chosen when sampling, positive values select smaller levels
+            void set_lod_bias(float);
+            float get_lod_bias() const;
+
             void set_wrap_mode(WrapMode);
             WrapMode get_wrap_mode();
 
@@ -45,12 +70,50 @@ namespace mousetrap
 
             Vector2i get_size() const;
 
-            GLNativeHandle get_native_handle() const;
+            GLNativeHandle get_native_handle() const override;
+
+            struct MemoryStatistics
+            {
+                struct Entry
+                {
+                    size_t n_textures = 0;
+                    size_t n_bytes = 0;
+                };
+
+                std::map<TextureFormat, Entry> per_format;
+                size_t n_bytes = 0;
+            };
+
+            /// \brief gpu memory allocated by all textures, estimated from size and format
+            static MemoryStatistics get_memory_statistics();
+
+            static size_t get_bytes_per_texel(TextureFormat);
 
         private:
             GLNativeHandle _native_handle = 0;
             WrapMode _wrap_mode = WrapMode::STRETCH;
             ScaleMode _scale_mode = ScaleMode::NEAREST;
+            mutable bool _parameters_changed = true;
+
+            TextureFormat _format = TextureFormat::RGBA8;
+            size_t _n_bytes = 0;
+
+            size_t _n_levels = 1;
+            float _lod_bias = 0;
+
+            void upload_level(GLint level, size_t width, size_t height, TextureFormat, const void* data, GLenum client_format, GLenum client_type, GLint alignment);
+            void upload_image(GLint level, const Image&, TextureFormat);
+            void on_allocated(size_t width, size_t height, TextureFormat, size_t n_levels, size_t n_bytes);
+            void set_memory_usage(size_t n_bytes);
+            void release_memory();
+
+            /// \brief expects this texture to be bound to the active unit
+            void generate_mipmaps_on_bound_unit();
+
+            /// \brief image format and client type download reads into
+            std::pair<ImageFormat, GLenum> get_download_format() const;
+
+            static inline MemoryStatistics _memory_statistics;
 
             Vector2i _size;
     };
@@ -0,0 +1,69 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "image.hpp"
+#include "texture.hpp"
+#include "geometry.hpp"
+#include "shape.hpp"
+
+namespace mousetrap
+{
+    /// \brief packs many images into few large textures, so shapes using different images can share one texture and be batched
+    class TextureAtlas
+    {
+        public:
+            using RegionID = size_t;
+
+            struct Region
+            {
+                /// \brief index of the page texture, c.f. get_page
+                size_t page;
+
+                /// \brief in pixels, excluding padding
+                Vector2ui position;
+                Vector2ui size;
+
+                /// \brief in texture coordinates of the page
+                Rectangle texture_coordinates;
+            };
+
+            /// \param padding: border in pixels around each image, filled by repeating the images edge pixels, prevents bleeding when filtering
+            TextureAtlas(size_t page_width = 2048, size_t page_height = 2048, size_t padding = 1, TextureFormat = TextureFormat::RGBA8);
+
+            TextureAtlas(const TextureAtlas&) = delete;
+            TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+            /// \brief queue an image, it is placed on the next call to build
+            RegionID add(const Image&);
+
+            /// \brief pack all added images and upload the pages, regions of previously built images may move
+            /// \returns false if at least one image is larger than a page, its region will be empty
+            bool build();
+
+            const Region& get_region(RegionID) const;
+            size_t get_n_regions() const;
+
+            const Texture* get_page(size_t) const;
+            size_t get_n_pages() const;
+
+            /// \brief set texture of shape to the regions page and map its texture coordinates from [0, 1] into the region
+            /// \note coordinates are assumed to address the whole image, applying twice remaps twice
+            void apply_to(Shape&, RegionID) const;
+
+        private:
+            size_t _page_width;
+            size_t _page_height;
+            size_t _padding;
+            TextureFormat _format;
+
+            std::vector<Image> _images;
+            std::vector<Region> _regions;
+            std::vector<std::unique_ptr<Texture>> _pages;
+    };
+}
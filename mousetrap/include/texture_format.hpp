@@ -0,0 +1,21 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include "gl_common.hpp"
+
+namespace mousetrap
+{
+    /// \brief internal format of a texture on the gpu
+    enum class TextureFormat
+    {
+        RGBA8 = GL_RGBA8,
+        SRGB8_ALPHA8 = GL_SRGB8_ALPHA8, // rgb are decoded from srgb to linear when sampled
+        R8 = GL_R8,
+        RG8 = GL_RG8,
+        RGBA16F = GL_RGBA16F,
+        RGBA32F = GL_RGBA32F
+    };
+}
@@ -0,0 +1,127 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "texture.hpp"
+#include "texture_object.hpp"
+#include "image.hpp"
+
+namespace mousetrap
+{
+    /// \brief texture that is loaded in the background, binds a placeholder until its pixels are uploaded
+    class AsyncTexture : public TextureObject
+    {
+        friend class TextureLoader;
+
+        public:
+            AsyncTexture(const AsyncTexture&) = delete;
+            AsyncTexture& operator=(const AsyncTexture&) = delete;
+
+            bool is_ready() const;
+            bool has_failed() const;
+
+            /// \brief nullptr until ready
+            const Texture* get_texture() const;
+
+            void bind() const override;
+            void unbind() const override;
+            GLNativeHandle get_native_handle() const override;
+
+        private:
+            AsyncTexture(const Texture* placeholder);
+
+            enum class State
+            {
+                DECODING,
+                UPLOADING,
+                READY,
+                FAILED
+            };
+
+            State _state = State::DECODING;
+            Texture _texture;
+            const Texture* _placeholder;
+    };
+
+    /// \brief decodes images on a worker pool and uploads them on the gl thread in time-sliced chunks through pixel buffer objects
+    class TextureLoader
+    {
+        public:
+            /// \param upload_budget: bytes uploaded per call to update, bounds the time update takes per frame
+            TextureLoader(size_t n_threads = std::max<size_t>(1, std::max(1u, std::thread::hardware_concurrency()) - 1), size_t upload_budget = 4 * 1024 * 1024);
+            ~TextureLoader();
+
+            TextureLoader(const TextureLoader&) = delete;
+            TextureLoader& operator=(const TextureLoader&) = delete;
+
+            /// \brief start loading, call on the gl thread. The returned texture can be used right away, it shows the placeholder until ready
+            /// \note the loader has to outlive the textures it returned, they reference its placeholder
+            /// \param format: RGBA8 or SRGB8_ALPHA8
+            std::shared_ptr<AsyncTexture> load(const std::string& path, TextureFormat format = TextureFormat::RGBA8);
+
+            /// \brief upload decoded images, call once per frame on the gl thread
+            void update();
+
+            /// \brief block until all queued textures are ready or failed
+            void finish();
+
+            /// \brief number of textures not yet ready or failed
+            size_t get_n_pending() const;
+
+            /// \brief shown by textures while they load, 1x1 transparent by default
+            void set_placeholder(const Image&);
+
+        private:
+            struct Job
+            {
+                std::shared_ptr<AsyncTexture> target;
+                std::string path;
+                TextureFormat format;
+            };
+
+            struct Upload
+            {
+                std::shared_ptr<AsyncTexture> target;
+                Image image;
+                TextureFormat format;
+                bool success;
+                size_t next_row = 0;
+            };
+
+            void worker_main();
+
+            /// \returns number of bytes uploaded
+            size_t upload_rows(Upload&, size_t max_bytes);
+
+            std::vector<std::thread> _workers;
+            bool _should_exit = false;
+
+            mutable std::mutex _mutex;
+            std::condition_variable _job_available;
+            std::deque<Job> _jobs;
+            std::deque<Upload> _decoded;
+
+            // gl thread only
+            std::deque<Upload> _uploads;
+            size_t _upload_budget;
+            size_t _n_pending = 0;
+
+            // orphaned on every chunk, so writing never waits for the gpu to finish reading the previous chunk
+            static constexpr size_t n_pixel_buffers = 3;
+            std::array<GLNativeHandle, n_pixel_buffers> _pixel_buffers;
+            size_t _current_pixel_buffer = 0;
+
+            Texture _placeholder;
+    };
+}
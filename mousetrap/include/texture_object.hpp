@@ -5,11 +5,14 @@
 
 #pragma once
 
+#include "gl_common.hpp"
+
 namespace mousetrap
 {
     struct TextureObject
     {
         virtual void bind() const = 0;
         virtual void unbind() const = 0;
+        virtual GLNativeHandle get_native_handle() const = 0;
     };
 }
@@ -0,0 +1,68 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <future>
+
+#include "texture.hpp"
+#include "image.hpp"
+
+namespace mousetrap
+{
+    /// \brief reads textures back into images without stalling, the gpu copies into a ring of pixel buffer objects and results are resolved once their fence signaled
+    class TextureReadback
+    {
+        public:
+            using Callback = std::function<void(Image)>;
+
+            /// \param n_buffers: number of reads that can be in flight, for continuous capture about the number of frames the gpu lags behind
+            TextureReadback(size_t n_buffers = 3);
+            ~TextureReadback();
+
+            TextureReadback(const TextureReadback&) = delete;
+            TextureReadback& operator=(const TextureReadback&) = delete;
+
+            /// \brief queue a read of the textures current content, call on the gl thread. Callback is invoked from update or finish
+            /// \note if all buffers are in flight, waits for the oldest read, c.f. get_n_stalls
+            void read(const Texture&, Callback);
+
+            /// \brief future is ready after the update that resolved the read
+            [[nodiscard]] std::future<Image> read(const Texture&);
+
+            /// \brief resolve all reads the gpu has finished, does not block, call once per frame on the gl thread
+            void update();
+
+            /// \brief block until all queued reads are resolved
+            void finish();
+
+            /// \brief number of reads not yet resolved
+            size_t get_n_pending() const;
+
+            /// \brief number of reads that had to wait because all buffers were in flight
+            size_t get_n_stalls() const;
+
+        private:
+            struct Slot
+            {
+                GLNativeHandle buffer = 0;
+                size_t capacity = 0;
+                GLsync fence = nullptr;
+
+                Vector2ui size;
+                ImageFormat format;
+                Callback callback;
+            };
+
+            /// \param wait: block until the fence signaled, otherwise return false if it has not
+            bool resolve(Slot&, bool wait);
+
+            std::vector<Slot> _slots;
+            size_t _next = 0;
+            size_t _n_pending = 0;
+            size_t _n_stalls = 0;
+    };
+}
@@ -0,0 +1,96 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#include "gl_common.hpp"
+
+namespace mousetrap
+{
+    /// \brief gl uniform buffer object, shared by all shaders that declare a matching uniform block
+    /// data is shadowed on the cpu and uploaded at most once per change, on the first bind after it
+    class UniformBufferObject
+    {
+        public:
+            /// \param binding_point: index of the gl uniform buffer binding, should be unique per buffer
+            /// \param size: size of the block in bytes
+            UniformBufferObject(size_t binding_point, size_t size);
+            ~UniformBufferObject();
+
+            UniformBufferObject(const UniformBufferObject&) = delete;
+            UniformBufferObject& operator=(const UniformBufferObject&) = delete;
+
+            size_t get_binding_point() const;
+            size_t get_size() const;
+            GLNativeHandle get_native_handle() const;
+
+            /// \brief upload pending changes, then bind to the binding point
+            void bind();
+
+        protected:
+            void write(const void* data, size_t offset, size_t size);
+            const void* read(size_t offset) const;
+
+        private:
+            void update_data();
+
+            GLNativeHandle _buffer_id = 0;
+            size_t _binding_point;
+
+            std::vector<uint8_t> _data;
+            bool _reallocate = true;
+            size_t _dirty_begin = 0;
+            size_t _dirty_end = 0;
+    };
+
+    /// \brief uniform buffer with the layout of a c++ struct
+    /// \note T has to match the std140 layout of the glsl block: scalars align to 4 bytes, vec2 to 8, vec3, vec4 and mat4 to 16.
+    ///       Declare members in block order and use alignas where needed, e.g. `alignas(16) glm::vec3 position; float radius;`
+    ///
+    /// Example, glsl: `layout(std140) uniform camera { mat4 view; vec4 tint; };`
+    ///          c++:  `struct Camera { glm::mat4 view; glm::vec4 tint; }; UniformBuffer<Camera> buffer(0);`
+    template<typename T>
+    class UniformBuffer : public UniformBufferObject
+    {
+        static_assert(std::is_trivially_copyable_v<T> and std::is_standard_layout_v<T>, "uniform buffer data has to be trivially copyable and have standard layout");
+        static_assert(sizeof(T) % 16 == 0, "size of std140 uniform blocks is a multiple of 16 bytes, add padding to the end of the struct");
+
+        public:
+            UniformBuffer(size_t binding_point)
+                : UniformBufferObject(binding_point, sizeof(T))
+            {
+                set(T());
+            }
+
+            UniformBuffer(size_t binding_point, const T& data)
+                : UniformBufferObject(binding_point, sizeof(T))
+            {
+                set(data);
+            }
+
+            void set(const T& data)
+            {
+                write(&data, 0, sizeof(T));
+            }
+
+            /// \brief update a single member, e.g. `buffer.set_member(&Camera::view, view)`
+            template<typename Member>
+            void set_member(Member T::* member, const Member& value)
+            {
+                // offset of a member in a standard layout struct
+                static const T probe = T();
+                size_t offset = reinterpret_cast<const uint8_t*>(&(probe.*member)) - reinterpret_cast<const uint8_t*>(&probe);
+                write(&value, offset, sizeof(Member));
+            }
+
+            const T& get() const
+            {
+                return *static_cast<const T*>(read(0));
+            }
+    };
+}
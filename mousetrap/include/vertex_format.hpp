@@ -0,0 +1,125 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <glm/gtc/packing.hpp>
+
+#include "gl_common.hpp"
+#include "colors.hpp"
+#include "shader.hpp"
+
+namespace mousetrap
+{
+    enum class VertexFormat
+    {
+        DEFAULT,    // vec3 float position, vec4 float color, vec2 float texture coordinates, 36 bytes
+        COMPACT     // vec2 float position, rgba8 normalized color, vec2 half-float texture coordinates, 16 bytes
+    };
+
+    struct VertexAttribute
+    {
+        int location;
+        GLint n_components;
+        GLenum type;
+        GLboolean normalized;
+        size_t offset;
+    };
+
+    /// \brief memory layout of one vertex in a vertex buffer, specialized per format
+    template<VertexFormat Format>
+    struct VertexLayout;
+
+    template<>
+    struct VertexLayout<VertexFormat::DEFAULT>
+    {
+        struct Data
+        {
+            float _position[3];
+            float _color[4];
+            float _texture_coordinates[2];
+        };
+
+        static void write_position(Data& data, Vector3f position)
+        {
+            data._position[0] = position.x;
+            data._position[1] = position.y;
+            data._position[2] = position.z;
+        }
+
+        static void write_color(Data& data, RGBA color)
+        {
+            data._color[0] = color.r;
+            data._color[1] = color.g;
+            data._color[2] = color.b;
+            data._color[3] = color.a;
+        }
+
+        static void write_texture_coordinates(Data& data, Vector2f coordinates)
+        {
+            data._texture_coordinates[0] = coordinates.x;
+            data._texture_coordinates[1] = coordinates.y;
+        }
+
+        static std::array<VertexAttribute, 3> get_attributes()
+        {
+            return {
+                VertexAttribute{Shader::get_vertex_position_location(), 3, GL_FLOAT, GL_FALSE, offsetof(Data, _position)},
+                VertexAttribute{Shader::get_vertex_color_location(), 4, GL_FLOAT, GL_FALSE, offsetof(Data, _color)},
+                VertexAttribute{Shader::get_vertex_texture_coordinate_location(), 2, GL_FLOAT, GL_FALSE, offsetof(Data, _texture_coordinates)}
+            };
+        }
+    };
+
+    template<>
+    struct VertexLayout<VertexFormat::COMPACT>
+    {
+        struct Data
+        {
+            float _position[2];
+            uint8_t _color[4];
+            uint16_t _texture_coordinates[2];
+        };
+
+        /// \note z component is dropped, shaders receive z = 0
+        static void write_position(Data& data, Vector3f position)
+        {
+            data._position[0] = position.x;
+            data._position[1] = position.y;
+        }
+
+        static void write_color(Data& data, RGBA color)
+        {
+            auto to_byte = [](float v) -> uint8_t {
+                return uint8_t(glm::clamp(v, 0.f, 1.f) * 255.f + 0.5f);
+            };
+
+            data._color[0] = to_byte(color.r);
+            data._color[1] = to_byte(color.g);
+            data._color[2] = to_byte(color.b);
+            data._color[3] = to_byte(color.a);
+        }
+
+        static void write_texture_coordinates(Data& data, Vector2f coordinates)
+        {
+            data._texture_coordinates[0] = glm::packHalf1x16(coordinates.x);
+            data._texture_coordinates[1] = glm::packHalf1x16(coordinates.y);
+        }
+
+        static std::array<VertexAttribute, 3> get_attributes()
+        {
+            return {
+                VertexAttribute{Shader::get_vertex_position_location(), 2, GL_FLOAT, GL_FALSE, offsetof(Data, _position)},
+                VertexAttribute{Shader::get_vertex_color_location(), 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Data, _color)},
+                VertexAttribute{Shader::get_vertex_texture_coordinate_location(), 2, GL_HALF_FLOAT, GL_FALSE, offsetof(Data, _texture_coordinates)}
+            };
+        }
+    };
+
+    static_assert(sizeof(VertexLayout<VertexFormat::DEFAULT>::Data) == 36);
+    static_assert(sizeof(VertexLayout<VertexFormat::COMPACT>::Data) == 16);
+}
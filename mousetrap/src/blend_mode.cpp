@@ -30,23 +30,23 @@ namespace mousetrap
         //
         //
 
-        glEnable(GL_BLEND);
+        GLStateCache::set_blend_enabled(mode != NONE);
 
         if (mode == NORMAL)
         {
             // O.rgb = S.a * S.rgb + (1 - S.a) * D.rgb
             // O.a = 1 * S.a + (1 - S.a) * D.a
 
-            glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-            glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            GLStateCache::set_blend_equation(GL_FUNC_ADD, GL_FUNC_ADD);
+            GLStateCache::set_blend_function(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
         }
         else if (mode == ADD)
         {
             // O.rgb = S.a * S.rgb + 1 * D.rgb
             // O.a = 1 * S.a + 1 * D.a
 
-            glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-            glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
+            GLStateCache::set_blend_equation(GL_FUNC_ADD, GL_FUNC_ADD);
+            GLStateCache::set_blend_function(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
         }
         else if (mode == MULTIPLY)
         {
@@ -55,13 +55,13 @@ namespace mousetrap
 
             if (allow_alpha_blend)
             {
-                glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-                glBlendFuncSeparate(GL_DST_COLOR, GL_ZERO, GL_DST_ALPHA, GL_ZERO);
+                GLStateCache::set_blend_equation(GL_FUNC_ADD, GL_FUNC_ADD);
+                GLStateCache::set_blend_function(GL_DST_COLOR, GL_ZERO, GL_DST_ALPHA, GL_ZERO);
             }
             else
             {
-                glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-                glBlendFuncSeparate(GL_DST_COLOR, GL_ZERO,  GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                GLStateCache::set_blend_equation(GL_FUNC_ADD, GL_FUNC_ADD);
+                GLStateCache::set_blend_function(GL_DST_COLOR, GL_ZERO,  GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
             }
         }
         else if (mode == MIN)
@@ -71,13 +71,13 @@ namespace mousetrap
 
             if (allow_alpha_blend)
             {
-                glBlendEquationSeparate(GL_MIN, GL_MIN);
-                glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+                GLStateCache::set_blend_equation(GL_MIN, GL_MIN);
+                GLStateCache::set_blend_function(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
             }
             else
             {
-                glBlendEquationSeparate(GL_MIN, GL_ADD);
-                glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                GLStateCache::set_blend_equation(GL_MIN, GL_ADD);
+                GLStateCache::set_blend_function(GL_ONE, GL_ONE, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
             }
         }
         else if (mode == MAX)
@@ -87,13 +87,13 @@ namespace mousetrap
 
             if (allow_alpha_blend)
             {
-                glBlendEquationSeparate(GL_MAX, GL_MAX);
-                glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+                GLStateCache::set_blend_equation(GL_MAX, GL_MAX);
+                GLStateCache::set_blend_function(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
             }
             else
             {
-                glBlendEquationSeparate(GL_MAX, GL_ADD);
-                glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                GLStateCache::set_blend_equation(GL_MAX, GL_ADD);
+                GLStateCache::set_blend_function(GL_ONE, GL_ONE, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
             }
 
         }
@@ -104,13 +104,13 @@ namespace mousetrap
 
             if (allow_alpha_blend)
             {
-                glBlendEquationSeparate(GL_FUNC_SUBTRACT, GL_FUNC_SUBTRACT); // sic
-                glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
+                GLStateCache::set_blend_equation(GL_FUNC_SUBTRACT, GL_FUNC_SUBTRACT); // sic
+                GLStateCache::set_blend_function(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
             }
             else
             {
-                glBlendEquationSeparate(GL_FUNC_SUBTRACT, GL_ADD); // sic
-                glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                GLStateCache::set_blend_equation(GL_FUNC_SUBTRACT, GL_ADD); // sic
+                GLStateCache::set_blend_function(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
             }
         }
         else if (mode == SUBTRACT)
@@ -120,17 +120,17 @@ namespace mousetrap
 
             if (allow_alpha_blend)
             {
-                glBlendEquationSeparate(GL_FUNC_REVERSE_SUBTRACT, GL_FUNC_REVERSE_SUBTRACT); // sic
-                glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
+                GLStateCache::set_blend_equation(GL_FUNC_REVERSE_SUBTRACT, GL_FUNC_REVERSE_SUBTRACT); // sic
+                GLStateCache::set_blend_function(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
             }
             else
             {
-                glBlendEquationSeparate(GL_FUNC_REVERSE_SUBTRACT, GL_ADD); // sic
-                glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+                GLStateCache::set_blend_equation(GL_FUNC_REVERSE_SUBTRACT, GL_ADD); // sic
+                GLStateCache::set_blend_function(GL_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
             }
         }
         else
-            glDisable(GL_BLEND);
+            GLStateCache::set_blend_enabled(false);
     }
 
     std::string blend_mode_to_string(BlendMode mode)
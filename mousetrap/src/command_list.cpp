@@ -0,0 +1,214 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/command_list.hpp"
+#include "mousetrap/include/shape_batch.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+namespace mousetrap
+{
+    void CommandList::push_command(GLenum render_type, const TextureObject* texture, Shader* shader, const GLTransform* transform, BlendMode blend_mode, uint8_t layer, size_t vertex_begin, size_t index_begin)
+    {
+        _commands.push_back(Command{
+            shader,
+            texture,
+            transform == nullptr ? GLTransform() : *transform,
+            blend_mode,
+            layer,
+            render_type,
+            vertex_begin, _vertices.size(),
+            index_begin, _indices.size()
+        });
+    }
+
+    void CommandList::draw(const Shape& shape, Shader* shader, const GLTransform* transform, BlendMode blend_mode, uint8_t layer)
+    {
+        if (not shape._visible or shape._vertices.empty() or shape._indices.empty())
+            return;
+
+        auto render_type = ShapeBatch::get_independent_render_type(shape._render_type);
+        if (render_type == GL_NONE)
+            return;
+
+        const size_t vertex_begin = _vertices.size();
+        const size_t index_begin = _indices.size();
+
+        for (const auto& vertex : shape._vertices)
+            _vertices.push_back(Vertex{shape.to_world_position(vertex.position), vertex.color, vertex.texture_coordinates});
+
+        ShapeBatch::append_independent_indices(shape._render_type, shape._indices, 0, _indices);
+        push_command(render_type, shape._texture, shader, transform, blend_mode, layer, vertex_begin, index_begin);
+    }
+
+    void CommandList::draw(std::span<const Vertex> vertices, std::span<const uint32_t> indices, GLenum render_type_in, const TextureObject* texture, Shader* shader, const GLTransform* transform, BlendMode blend_mode, uint8_t layer)
+    {
+        if (vertices.empty() or indices.empty())
+            return;
+
+        auto render_type = ShapeBatch::get_independent_render_type(render_type_in);
+        if (render_type == GL_NONE)
+        {
+            std::cerr << "[WARNING] In CommandList::draw: Render type " << render_type_in << " is not supported, command will be ignored" << std::endl;
+            return;
+        }
+
+        for (auto i : indices)
+        {
+            if (i >= vertices.size())
+            {
+                std::cerr << "[ERROR] In CommandList::draw: index " << i << " out of bounds for " << vertices.size() << " vertices, command will be ignored" << std::endl;
+                return;
+            }
+        }
+
+        const size_t vertex_begin = _vertices.size();
+        const size_t index_begin = _indices.size();
+
+        _vertices.insert(_vertices.end(), vertices.begin(), vertices.end());
+        ShapeBatch::append_independent_indices(render_type_in, indices, 0, _indices);
+        push_command(render_type, texture, shader, transform, blend_mode, layer, vertex_begin, index_begin);
+    }
+
+    void CommandList::draw_rectangle(Vector2f top_left, Vector2f size, RGBA color, const TextureObject* texture, Shader* shader, const GLTransform* transform, BlendMode blend_mode, uint8_t layer)
+    {
+        const Vertex vertices[] = {
+            {Vector3f(top_left.x, top_left.y, 0), color, Vector2f(0, 0)},
+            {Vector3f(top_left.x + size.x, top_left.y, 0), color, Vector2f(1, 0)},
+            {Vector3f(top_left.x + size.x, top_left.y + size.y, 0), color, Vector2f(1, 1)},
+            {Vector3f(top_left.x, top_left.y + size.y, 0), color, Vector2f(0, 1)}
+        };
+
+        const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+        draw(vertices, indices, GL_TRIANGLES, texture, shader, transform, blend_mode, layer);
+    }
+
+    void CommandList::clear()
+    {
+        _vertices.clear();
+        _indices.clear();
+        _commands.clear();
+    }
+
+    size_t CommandList::get_n_commands() const
+    {
+        return _commands.size();
+    }
+
+    // ###
+
+    /// \brief geometry of one merged run of commands, reused across submits so its gl objects are only created once
+    class CommandSubmitter::Batch : public Shape
+    {
+        public:
+            void begin(GLenum render_type, const TextureObject* texture)
+            {
+                _vertices.clear();
+                _indices.clear();
+                _render_type = render_type;
+                _texture = texture;
+            }
+
+            void append(const CommandList& list, const CommandList::Command& command)
+            {
+                const uint32_t offset = _vertices.size();
+
+                for (size_t i = command.vertex_begin; i < command.vertex_end; ++i)
+                {
+                    const auto& in = list._vertices[i];
+                    auto& out = _vertices.emplace_back(in.position.x, in.position.y, in.color);
+                    out.position = in.position;
+                    out.texture_coordinates = in.texture_coordinates;
+                }
+
+                for (size_t i = command.index_begin; i < command.index_end; ++i)
+                    _indices.push_back(offset + list._indices[i]);
+            }
+
+            void draw(Shader& shader, GLTransform transform)
+            {
+                upload_vertices();
+                Shape::draw(shader, transform);
+            }
+    };
+
+    CommandSubmitter::CommandSubmitter()
+    {
+        if (noop_shader == nullptr)
+            noop_shader = new Shader();
+    }
+
+    CommandSubmitter::~CommandSubmitter() = default;
+
+    void CommandSubmitter::submit(const std::vector<const CommandList*>& lists)
+    {
+        _statistics = Statistics();
+        _entries.clear();
+
+        for (auto* list : lists)
+        {
+            if (list == nullptr)
+                continue;
+
+            for (const auto& command : list->_commands)
+                _entries.push_back({list, &command});
+        }
+
+        _statistics.n_commands = _entries.size();
+
+        // list order and recording order are already in _entries, a stable sort keeps them within a layer
+
+        std::stable_sort(_entries.begin(), _entries.end(), [](const Entry& a, const Entry& b){
+            return a.command->layer < b.command->layer;
+        });
+
+        auto same_state = [](const CommandList::Command& a, const CommandList::Command& b){
+            return a.shader == b.shader
+                and a.texture == b.texture
+                and a.blend_mode == b.blend_mode
+                and a.render_type == b.render_type
+                and a.transform.transform == b.transform.transform;
+        };
+
+        size_t n_batches = 0;
+        size_t i = 0;
+        while (i < _entries.size())
+        {
+            const auto& first = *_entries.at(i).command;
+
+            if (n_batches >= _batches.size())
+                _batches.emplace_back(new Batch());
+
+            auto& batch = *_batches.at(n_batches);
+            batch.begin(first.render_type, first.texture);
+
+            // merge run of commands with identical state into one draw call, layers are kept in order since the run is consecutive
+
+            while (i < _entries.size() and same_state(first, *_entries.at(i).command))
+            {
+                batch.append(*_entries.at(i).list, *_entries.at(i).command);
+                i += 1;
+            }
+
+            auto* shader = first.shader == nullptr ? noop_shader : first.shader;
+            GLStateCache::use_program(shader->get_program_id());
+
+            if (first.texture != nullptr)
+                first.texture->bind();
+
+            set_current_blend_mode(first.blend_mode);
+            batch.draw(*shader, first.transform);
+
+            n_batches += 1;
+        }
+
+        _statistics.n_draw_calls = n_batches;
+    }
+
+    CommandSubmitter::Statistics CommandSubmitter::get_statistics() const
+    {
+        return _statistics;
+    }
+}
@@ -0,0 +1,157 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/cpu_profiler.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace mousetrap
+{
+    CPUProfiler::Zone::Zone(const char* name)
+        : _name(name), _begin(CPUProfiler::now())
+    {}
+
+    CPUProfiler::Zone::~Zone()
+    {
+        CPUProfiler::push(_name, _begin, CPUProfiler::now());
+    }
+
+    uint64_t CPUProfiler::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void CPUProfiler::set_enabled(bool b)
+    {
+        _enabled.store(b, std::memory_order_relaxed);
+    }
+
+    bool CPUProfiler::get_enabled()
+    {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    CPUProfiler::ThreadBuffer& CPUProfiler::get_thread_buffer()
+    {
+        // buffers are owned by the profiler, so events of finished threads can still be exported
+
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr)
+        {
+            auto lock = std::lock_guard(_buffers_lock);
+            _buffers.emplace_back(new ThreadBuffer());
+            buffer = _buffers.back().get();
+            buffer->thread_id = _buffers.size() - 1;
+        }
+
+        return *buffer;
+    }
+
+    void CPUProfiler::push(const char* name, uint64_t begin, uint64_t end)
+    {
+        if (not _enabled.load(std::memory_order_relaxed))
+            return;
+
+        auto& buffer = get_thread_buffer();
+        auto n = buffer.n_events.load(std::memory_order_relaxed);
+
+        if (n >= events_per_thread)
+        {
+            buffer.n_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[n] = Event{name, begin, end};
+        buffer.n_events.store(n + 1, std::memory_order_release);
+    }
+
+    static void write_json_string(std::ostream& out, const char* str)
+    {
+        out << '"';
+        for (const char* c = str; *c != '\0'; ++c)
+        {
+            if (*c == '"' or *c == '\\')
+                out << '\\' << *c;
+            else if (*c == '\n')
+                out << "\\n";
+            else
+                out << *c;
+        }
+        out << '"';
+    }
+
+    std::string CPUProfiler::to_chrome_trace()
+    {
+        // complete events ("ph": "X"), timestamps and durations in microseconds
+
+        auto out = std::stringstream();
+        out << std::fixed << std::setprecision(3);
+        out << "{\"traceEvents\":[";
+
+        bool first = true;
+        auto lock = std::lock_guard(_buffers_lock);
+        for (auto& buffer : _buffers)
+        {
+            auto n = buffer->n_events.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const auto& event = buffer->events[i];
+
+                if (not first)
+                    out << ",";
+
+                out << "\n{\"name\":";
+                write_json_string(out, event.name);
+                out << ",\"cat\":\"mousetrap\",\"ph\":\"X\""
+                    << ",\"ts\":" << event.begin / 1000.0
+                    << ",\"dur\":" << (event.end - event.begin) / 1000.0
+                    << ",\"pid\":0"
+                    << ",\"tid\":" << buffer->thread_id
+                    << "}";
+
+                first = false;
+            }
+        }
+
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        return out.str();
+    }
+
+    bool CPUProfiler::write_chrome_trace(const std::string& path)
+    {
+        auto file = std::ofstream(path);
+        if (not file.is_open())
+        {
+            std::cerr << "[WARNING] In CPUProfiler::write_chrome_trace: Unable to open file at `" << path << "`" << std::endl;
+            return false;
+        }
+
+        file << to_chrome_trace();
+        return true;
+    }
+
+    void CPUProfiler::clear()
+    {
+        auto lock = std::lock_guard(_buffers_lock);
+        for (auto& buffer : _buffers)
+        {
+            buffer->n_events.store(0, std::memory_order_release);
+            buffer->n_dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t CPUProfiler::get_n_dropped_events()
+    {
+        size_t out = 0;
+
+        auto lock = std::lock_guard(_buffers_lock);
+        for (auto& buffer : _buffers)
+            out += buffer->n_dropped.load(std::memory_order_relaxed);
+
+        return out;
+    }
+}
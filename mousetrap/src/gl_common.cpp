@@ -46,4 +46,197 @@ namespace mousetrap
         auto xy = from_gl_position({in.x, in.y});
         return {xy.x, xy.y, in.z};
     }
+
+    glm::mat4 get_gl_projection()
+    {
+        // x' = 2x - 1, y' = 1 - 2y
+
+        auto out = glm::mat4(1);
+        out[0][0] = 2;
+        out[1][1] = -2;
+        out[3][0] = -1;
+        out[3][1] = 1;
+        return out;
+    }
+
+    bool GLStateCache::should_issue(bool changed)
+    {
+        if (changed)
+            _statistics.n_issued += 1;
+        else
+            _statistics.n_skipped += 1;
+
+        return changed;
+    }
+
+    void GLStateCache::use_program(GLNativeHandle id)
+    {
+        if (should_issue(id != _program))
+        {
+            glUseProgram(id);
+            _program = id;
+        }
+    }
+
+    void GLStateCache::bind_vertex_array(GLNativeHandle id)
+    {
+        if (should_issue(id != _vertex_array))
+        {
+            glBindVertexArray(id);
+            _vertex_array = id;
+        }
+    }
+
+    void GLStateCache::bind_texture(size_t texture_unit, GLNativeHandle id)
+    {
+        if (texture_unit >= n_texture_units)
+        {
+            glActiveTexture(GL_TEXTURE0 + texture_unit);
+            glBindTexture(GL_TEXTURE_2D, id);
+            _active_texture_unit = GL_TEXTURE0 + texture_unit;
+            _statistics.n_issued += 2;
+            return;
+        }
+
+        // callers edit the texture after binding it, so the unit is made active even if the binding is cached
+
+        if (GL_TEXTURE0 + texture_unit != _active_texture_unit)
+        {
+            glActiveTexture(GL_TEXTURE0 + texture_unit);
+            _active_texture_unit = GL_TEXTURE0 + texture_unit;
+            _statistics.n_issued += 1;
+        }
+
+        if (should_issue(id != _textures[texture_unit]))
+        {
+            glBindTexture(GL_TEXTURE_2D, id);
+            _textures[texture_unit] = id;
+        }
+    }
+
+    void GLStateCache::bind_framebuffer(GLNativeHandle id)
+    {
+        if (should_issue(id != _framebuffer))
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, id);
+            _framebuffer = id;
+        }
+    }
+
+    GLNativeHandle GLStateCache::get_framebuffer()
+    {
+        if (_framebuffer == unknown)
+        {
+            GLint id = 0;
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &id);
+            _framebuffer = id;
+        }
+
+        return _framebuffer;
+    }
+
+    void GLStateCache::bind_uniform_buffer(size_t binding_point, GLNativeHandle id)
+    {
+        if (binding_point >= n_uniform_buffer_bindings)
+        {
+            glBindBufferBase(GL_UNIFORM_BUFFER, binding_point, id);
+            _statistics.n_issued += 1;
+            return;
+        }
+
+        if (should_issue(id != _uniform_buffers[binding_point]))
+        {
+            glBindBufferBase(GL_UNIFORM_BUFFER, binding_point, id);
+            _uniform_buffers[binding_point] = id;
+        }
+    }
+
+    void GLStateCache::set_blend_enabled(bool b)
+    {
+        if (should_issue(int(b) != _blend_enabled))
+        {
+            if (b)
+                glEnable(GL_BLEND);
+            else
+                glDisable(GL_BLEND);
+
+            _blend_enabled = b;
+        }
+    }
+
+    void GLStateCache::set_blend_equation(GLenum rgb, GLenum alpha)
+    {
+        if (should_issue(rgb != _blend_equation[0] or alpha != _blend_equation[1]))
+        {
+            glBlendEquationSeparate(rgb, alpha);
+            _blend_equation = {rgb, alpha};
+        }
+    }
+
+    void GLStateCache::set_blend_function(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha)
+    {
+        auto function = std::array<GLenum, 4>{source_rgb, destination_rgb, source_alpha, destination_alpha};
+        if (should_issue(function != _blend_function))
+        {
+            glBlendFuncSeparate(source_rgb, destination_rgb, source_alpha, destination_alpha);
+            _blend_function = function;
+        }
+    }
+
+    void GLStateCache::on_program_deleted(GLNativeHandle id)
+    {
+        // deleting the bound program keeps it in use until another is bound, its id may be reused before that
+
+        if (_program == id)
+            _program = unknown;
+    }
+
+    void GLStateCache::on_vertex_array_deleted(GLNativeHandle id)
+    {
+        if (_vertex_array == id)
+            _vertex_array = 0;
+    }
+
+    void GLStateCache::on_texture_deleted(GLNativeHandle id)
+    {
+        for (auto& texture : _textures)
+            if (texture == id)
+                texture = 0;
+    }
+
+    void GLStateCache::on_framebuffer_deleted(GLNativeHandle id)
+    {
+        if (_framebuffer == id)
+            _framebuffer = 0;
+    }
+
+    void GLStateCache::on_buffer_deleted(GLNativeHandle id)
+    {
+        for (auto& buffer : _uniform_buffers)
+            if (buffer == id)
+                buffer = 0;
+    }
+
+    void GLStateCache::invalidate()
+    {
+        _program = unknown;
+        _vertex_array = unknown;
+        _framebuffer = unknown;
+        _active_texture_unit = unknown;
+        _textures.fill(unknown);
+        _uniform_buffers.fill(unknown);
+        _blend_enabled = -1;
+        _blend_equation = {unknown, unknown};
+        _blend_function = {unknown, unknown, unknown, unknown};
+    }
+
+    GLStateCache::Statistics GLStateCache::get_statistics()
+    {
+        return _statistics;
+    }
+
+    void GLStateCache::reset_statistics()
+    {
+        _statistics = Statistics();
+    }
 }
\ No newline at end of file
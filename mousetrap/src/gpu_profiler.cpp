@@ -0,0 +1,219 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/gpu_profiler.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace mousetrap
+{
+    void GPUProfiler::set_enabled(bool b)
+    {
+        if (b and not (GLEW_VERSION_3_3 or GLEW_ARB_timer_query))
+        {
+            std::cerr << "[WARNING] In GPUProfiler::set_enabled: Timer queries are not supported by this context, profiler will stay disabled" << std::endl;
+            return;
+        }
+
+        if (not b and _in_frame)
+            end_frame();
+
+        _enabled = b;
+    }
+
+    bool GPUProfiler::get_enabled()
+    {
+        return _enabled;
+    }
+
+    size_t GPUProfiler::get_name_id(const std::string& name)
+    {
+        auto it = _name_to_id.find(name);
+        if (it != _name_to_id.end())
+            return it->second;
+
+        size_t id = _names.size();
+        _names.push_back(name);
+        _history.emplace_back();
+        _name_to_id.insert({name, id});
+        return id;
+    }
+
+    size_t GPUProfiler::issue_timestamp(Frame& frame)
+    {
+        // queries are pooled per frame and never deleted until reset
+
+        if (frame.n_queries_used >= frame.queries.size())
+        {
+            frame.queries.emplace_back(0);
+            glGenQueries(1, &frame.queries.back());
+        }
+
+        auto index = frame.n_queries_used++;
+        glQueryCounter(frame.queries.at(index), GL_TIMESTAMP);
+        return index;
+    }
+
+    void GPUProfiler::begin_frame()
+    {
+        if (not _enabled)
+            return;
+
+        if (_in_frame)
+            end_frame();
+
+        _current_frame = (_current_frame + 1) % n_frames_in_flight;
+        auto& frame = _frames.at(_current_frame);
+
+        if (frame.pending)
+            collect(frame);
+
+        frame.n_queries_used = 0;
+        frame.samples.clear();
+        frame.pending = false;
+
+        _in_frame = true;
+        begin_zone("frame");
+    }
+
+    void GPUProfiler::end_frame()
+    {
+        if (not _enabled or not _in_frame)
+            return;
+
+        if (_open_zones.size() > 1)
+            std::cerr << "[WARNING] In GPUProfiler::end_frame: " << _open_zones.size() - 1 << " zones were not ended, they will be closed at the end of the frame" << std::endl;
+
+        while (not _open_zones.empty())
+            end_zone();
+
+        _frames.at(_current_frame).pending = true;
+        _in_frame = false;
+    }
+
+    void GPUProfiler::begin_zone(const std::string& name)
+    {
+        if (not _enabled or not _in_frame)
+            return;
+
+        auto& frame = _frames.at(_current_frame);
+        frame.samples.push_back(Sample{get_name_id(name), issue_timestamp(frame), size_t(-1)});
+        _open_zones.push_back(frame.samples.size() - 1);
+    }
+
+    void GPUProfiler::end_zone()
+    {
+        if (not _enabled or not _in_frame)
+            return;
+
+        if (_open_zones.empty())
+        {
+            std::cerr << "[WARNING] In GPUProfiler::end_zone: No zone is open" << std::endl;
+            return;
+        }
+
+        auto& frame = _frames.at(_current_frame);
+        frame.samples.at(_open_zones.back()).end_query = issue_timestamp(frame);
+        _open_zones.pop_back();
+    }
+
+    void GPUProfiler::collect(Frame& frame)
+    {
+        if (frame.n_queries_used == 0)
+            return;
+
+        // queries complete in order, if the last one is done all are, otherwise drop the frame instead of waiting
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(frame.queries.at(frame.n_queries_used - 1), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available != GL_TRUE)
+        {
+            _n_dropped_frames += 1;
+            return;
+        }
+
+        auto get_timestamp = [&](size_t index) -> GLuint64 {
+            GLuint64 out = 0;
+            glGetQueryObjectui64v(frame.queries.at(index), GL_QUERY_RESULT, &out);
+            return out;
+        };
+
+        std::unordered_map<size_t, GLuint64> per_name;
+        for (const auto& sample : frame.samples)
+        {
+            if (sample.end_query == size_t(-1))
+                continue;
+
+            auto begin = get_timestamp(sample.begin_query);
+            auto end = get_timestamp(sample.end_query);
+            per_name[sample.name_id] += end > begin ? end - begin : 0;
+        }
+
+        for (auto& pair : per_name)
+        {
+            auto& history = _history.at(pair.first);
+            history.push_back(pair.second / 1e6f);
+
+            if (history.size() > history_size)
+                history.pop_front();
+        }
+    }
+
+    std::vector<GPUProfiler::Timing> GPUProfiler::get_timings()
+    {
+        std::vector<Timing> out;
+        std::vector<float> sorted;
+
+        for (size_t id = 0; id < _names.size(); ++id)
+        {
+            const auto& history = _history.at(id);
+            if (history.empty())
+                continue;
+
+            sorted.assign(history.begin(), history.end());
+            std::sort(sorted.begin(), sorted.end());
+
+            float sum = 0;
+            for (auto x : sorted)
+                sum += x;
+
+            size_t p99_index = size_t(std::ceil(0.99 * sorted.size())) - 1;
+
+            out.push_back(Timing{
+                _names.at(id),
+                sorted.front(),
+                sum / sorted.size(),
+                sorted.at(p99_index),
+                sorted.size()
+            });
+        }
+
+        return out;
+    }
+
+    size_t GPUProfiler::get_n_dropped_frames()
+    {
+        return _n_dropped_frames;
+    }
+
+    void GPUProfiler::reset()
+    {
+        for (auto& frame : _frames)
+        {
+            if (not frame.queries.empty())
+                glDeleteQueries(frame.queries.size(), frame.queries.data());
+
+            frame = Frame();
+        }
+
+        _in_frame = false;
+        _open_zones.clear();
+        _names.clear();
+        _name_to_id.clear();
+        _history.clear();
+        _n_dropped_frames = 0;
+    }
+}
@@ -4,105 +4,739 @@
 //
 
 #include "mousetrap/include/image.hpp"
+#include "mousetrap/include/cpu_profiler.hpp"
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+
+#if (defined(__x86_64__) or defined(__i386__)) and (defined(__GNUC__) or defined(__clang__))
+    #include <immintrin.h>
+    #define MOUSETRAP_IMAGE_RUNTIME_AVX2 1
+#else
+    #define MOUSETRAP_IMAGE_RUNTIME_AVX2 0
+#endif
 
 namespace mousetrap
 {
-    Image::Image(const Image& other)
+    size_t get_bytes_per_pixel(ImageFormat format)
+    {
+        switch (format)
+        {
+            case ImageFormat::RGBA8:
+                return 4 * sizeof(uint8_t);
+            case ImageFormat::RGBA16F:
+                return 4 * sizeof(uint16_t);
+            case ImageFormat::RGBA32F:
+                return 4 * sizeof(float);
+        }
+
+        return 4;
+    }
+
+    namespace
     {
-        _data = std::vector<float>();
-        _data.reserve(other._data.size());
-        for (auto v : other._data)
-            _data.push_back(v);
+        void encode_pixel(uint8_t* out, ImageFormat format, RGBA color)
+        {
+            if (format == ImageFormat::RGBA8)
+            {
+                auto to_byte = [](float v) -> uint8_t {
+                    return uint8_t(glm::clamp(v, 0.f, 1.f) * 255.f + 0.5f);
+                };
+
+                out[0] = to_byte(color.r);
+                out[1] = to_byte(color.g);
+                out[2] = to_byte(color.b);
+                out[3] = to_byte(color.a);
+            }
+            else if (format == ImageFormat::RGBA16F)
+            {
+                uint16_t half[4] = {
+                    glm::packHalf1x16(color.r),
+                    glm::packHalf1x16(color.g),
+                    glm::packHalf1x16(color.b),
+                    glm::packHalf1x16(color.a)
+                };
+                std::memcpy(out, half, sizeof(half));
+            }
+            else
+            {
+                float full[4] = {color.r, color.g, color.b, color.a};
+                std::memcpy(out, full, sizeof(full));
+            }
+        }
+
+        RGBA decode_pixel(const uint8_t* in, ImageFormat format)
+        {
+            if (format == ImageFormat::RGBA8)
+            {
+                return RGBA(
+                    in[0] / 255.f,
+                    in[1] / 255.f,
+                    in[2] / 255.f,
+                    in[3] / 255.f
+                );
+            }
+            else if (format == ImageFormat::RGBA16F)
+            {
+                uint16_t half[4];
+                std::memcpy(half, in, sizeof(half));
+                return RGBA(
+                    glm::unpackHalf1x16(half[0]),
+                    glm::unpackHalf1x16(half[1]),
+                    glm::unpackHalf1x16(half[2]),
+                    glm::unpackHalf1x16(half[3])
+                );
+            }
+            else
+            {
+                float full[4];
+                std::memcpy(full, in, sizeof(full));
+                return RGBA(full[0], full[1], full[2], full[3]);
+            }
+        }
+
+        // workers shared by all row kernels, started on first use so images that are never processed in parallel spawn no threads
+
+        class RowBandPool
+        {
+            public:
+                static RowBandPool& get()
+                {
+                    static RowBandPool pool;
+                    return pool;
+                }
+
+                /// \brief workers plus the calling thread
+                size_t get_n_threads() const
+                {
+                    return _workers.size() + 1;
+                }
+
+                /// \brief call task(i) for i in [0, n_tasks), the calling thread helps and returns once all calls finished
+                void run(size_t n_tasks, const std::function<void(size_t)>& task)
+                {
+                    // another thread is already using the pool, run inline instead of waiting for it
+
+                    auto run_lock = std::unique_lock(_run_mutex, std::try_to_lock);
+                    if (not run_lock.owns_lock())
+                    {
+                        for (size_t i = 0; i < n_tasks; ++i)
+                            task(i);
+                        return;
+                    }
+
+                    {
+                        auto lock = std::lock_guard(_mutex);
+                        _task = &task;
+                        _n_tasks = n_tasks;
+                        _next_task = 0;
+                        _n_remaining = n_tasks;
+                        _generation += 1;
+                    }
+
+                    _work_available.notify_all();
+                    work();
+
+                    auto lock = std::unique_lock(_mutex);
+                    _work_done.wait(lock, [&](){
+                        return _n_remaining == 0;
+                    });
+
+                    _task = nullptr;
+                }
+
+            private:
+                RowBandPool()
+                {
+                    const size_t n_workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+                    for (size_t i = 0; i < n_workers; ++i)
+                        _workers.emplace_back([this](){ worker_main(); });
+                }
+
+                ~RowBandPool()
+                {
+                    {
+                        auto lock = std::lock_guard(_mutex);
+                        _should_exit = true;
+                    }
+
+                    _work_available.notify_all();
+                    for (auto& worker : _workers)
+                        worker.join();
+                }
+
+                void worker_main()
+                {
+                    size_t seen = 0;
+                    while (true)
+                    {
+                        {
+                            auto lock = std::unique_lock(_mutex);
+                            _work_available.wait(lock, [&](){
+                                return _should_exit or _generation != seen;
+                            });
+
+                            if (_should_exit)
+                                return;
+
+                            seen = _generation;
+                        }
+
+                        work();
+                    }
+                }
+
+                void work()
+                {
+                    while (true)
+                    {
+                        const std::function<void(size_t)>* task;
+                        size_t i;
+
+                        {
+                            auto lock = std::lock_guard(_mutex);
+                            if (_task == nullptr or _next_task >= _n_tasks)
+                                return;
+
+                            task = _task;
+                            i = _next_task++;
+                        }
+
+                        (*task)(i);
+
+                        auto lock = std::lock_guard(_mutex);
+                        if (--_n_remaining == 0)
+                            _work_done.notify_all();
+                    }
+                }
+
+                std::vector<std::thread> _workers;
+                std::mutex _run_mutex;
+
+                std::mutex _mutex;
+                std::condition_variable _work_available;
+                std::condition_variable _work_done;
+                bool _should_exit = false;
+
+                const std::function<void(size_t)>* _task = nullptr;
+                size_t _n_tasks = 0;
+                size_t _next_task = 0;
+                size_t _n_remaining = 0;
+                size_t _generation = 0;
+        };
+
+        // split rows into one band per thread of the pool, small images are processed on the calling thread
+
+        template<typename Function_t>
+        void for_each_row_band(size_t n_rows, size_t n_bytes, Function_t&& f)
+        {
+            static constexpr size_t min_bytes_per_thread = 1 << 18;
+
+            size_t n_threads = std::max<size_t>(1, n_bytes / min_bytes_per_thread);
+            if (n_threads > 1)
+                n_threads = std::min(n_threads, RowBandPool::get().get_n_threads());
+
+            n_threads = std::clamp<size_t>(n_threads, 1, std::max<size_t>(1, n_rows));
+
+            if (n_threads == 1)
+            {
+                f(0, n_rows);
+                return;
+            }
+
+            const size_t band = (n_rows + n_threads - 1) / n_threads;
+            const size_t n_bands = (n_rows + band - 1) / band;
+
+            RowBandPool::get().run(n_bands, [&](size_t i){
+                f(i * band, std::min((i + 1) * band, n_rows));
+            });
+        }
+
+        // avx2 variants are compiled for their target regardless of build flags and selected at runtime
 
+        #if MOUSETRAP_IMAGE_RUNTIME_AVX2
+            bool has_avx2()
+            {
+                static const bool out = __builtin_cpu_supports("avx2");
+                return out;
+            }
+
+            /// \returns number of pixels processed, a multiple of 8
+            __attribute__((target("avx2")))
+            size_t reverse_pixels_avx2(const uint8_t* in, uint8_t* out, size_t n)
+            {
+                const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + (n - i - 8) * 4));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), _mm256_permutevar8x32_epi32(v, reverse));
+                }
+
+                return i;
+            }
+
+            __attribute__((target("avx2")))
+            __m256i blend_avx2(__m256i source, __m256i destination)
+            {
+                const __m256i rgb_mask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+                const __m256i alpha_one = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+
+                auto alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                auto source_factor = _mm256_or_si256(_mm256_and_si256(alpha, rgb_mask), alpha_one);
+                auto destination_factor = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+
+                auto x = _mm256_add_epi16(_mm256_mullo_epi16(source, source_factor), _mm256_mullo_epi16(destination, destination_factor));
+                x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+                return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+            }
+
+            /// \returns number of pixels processed, a multiple of 8
+            __attribute__((target("avx2")))
+            size_t blend_pixels_rgba8_avx2(const uint8_t* in, uint8_t* out, size_t n)
+            {
+                const __m256i zero = _mm256_setzero_si256();
+
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    auto source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 4));
+                    auto destination = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(out + i * 4));
+
+                    auto low = blend_avx2(_mm256_unpacklo_epi8(source, zero), _mm256_unpacklo_epi8(destination, zero));
+                    auto high = blend_avx2(_mm256_unpackhi_epi8(source, zero), _mm256_unpackhi_epi8(destination, zero));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), _mm256_packus_epi16(low, high));
+                }
+
+                return i;
+            }
+        #endif
+
+        // out[i] = in[n - 1 - i], in and out may not overlap
+
+        void reverse_pixels(const uint8_t* in, uint8_t* out, size_t n, size_t bytes_per_pixel)
+        {
+            size_t i = 0;
+
+            if (bytes_per_pixel == 4)
+            {
+                #if MOUSETRAP_IMAGE_RUNTIME_AVX2
+                    if (has_avx2())
+                        i = reverse_pixels_avx2(in, out, n);
+                #endif
+
+                #if defined(__SSE2__)
+                    for (; i + 4 <= n; i += 4)
+                    {
+                        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (n - i - 4) * 4));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+                    }
+                #endif
+            }
+
+            for (; i < n; ++i)
+                std::memcpy(out + i * bytes_per_pixel, in + (n - 1 - i) * bytes_per_pixel, bytes_per_pixel);
+        }
+
+        // same equation as BlendMode::NORMAL: O.rgb = S.a * S.rgb + (1 - S.a) * D.rgb, O.a = S.a + (1 - S.a) * D.a
+        // in 8-bit fixed point, with x / 255 computed as (x + 128 + ((x + 128) >> 8)) >> 8
+
+        void blend_pixels_rgba8(const uint8_t* in, uint8_t* out, size_t n)
+        {
+            size_t i = 0;
+
+            #if MOUSETRAP_IMAGE_RUNTIME_AVX2
+                if (has_avx2())
+                    i = blend_pixels_rgba8_avx2(in, out, n);
+            #endif
+
+            #if defined(__SSE2__)
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i rgb_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+                const __m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+                const __m128i one = _mm_set1_epi16(255);
+                const __m128i half = _mm_set1_epi16(128);
+
+                auto blend = [&](__m128i source, __m128i destination) -> __m128i {
+                    auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                    auto source_factor = _mm_or_si128(_mm_and_si128(alpha, rgb_mask), alpha_one);
+                    auto destination_factor = _mm_sub_epi16(one, alpha);
+
+                    auto x = _mm_add_epi16(_mm_mullo_epi16(source, source_factor), _mm_mullo_epi16(destination, destination_factor));
+                    x = _mm_add_epi16(x, half);
+                    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+                };
+
+                for (; i + 4 <= n; i += 4)
+                {
+                    auto source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 4));
+                    auto destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i * 4));
+
+                    auto low = blend(_mm_unpacklo_epi8(source, zero), _mm_unpacklo_epi8(destination, zero));
+                    auto high = blend(_mm_unpackhi_epi8(source, zero), _mm_unpackhi_epi8(destination, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), _mm_packus_epi16(low, high));
+                }
+            #endif
+
+            for (; i < n; ++i)
+            {
+                const uint32_t alpha = in[i * 4 + 3];
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    uint32_t x = in[i * 4 + c] * (c == 3 ? 255 : alpha) + out[i * 4 + c] * (255 - alpha) + 128;
+                    out[i * 4 + c] = (x + (x >> 8)) >> 8;
+                }
+            }
+        }
+
+        // ### RESAMPLING
+
+        float get_filter_support(InterpolationType type)
+        {
+            switch (type)
+            {
+                case InterpolationType::NEAREST:
+                    return 0.5;
+                case InterpolationType::BILINEAR:
+                    return 1;
+                case InterpolationType::BICUBIC:
+                    return 2;
+                case InterpolationType::LANCZOS:
+                    return 3;
+            }
+
+            return 1;
+        }
+
+        float evaluate_filter(InterpolationType type, float x)
+        {
+            x = std::abs(x);
+
+            if (type == InterpolationType::BILINEAR)
+                return std::max(0.f, 1 - x);
+            else if (type == InterpolationType::BICUBIC)
+            {
+                // catmull-rom, a = -0.5
+                if (x < 1)
+                    return 1.5f * x * x * x - 2.5f * x * x + 1;
+                else if (x < 2)
+                    return -0.5f * x * x * x + 2.5f * x * x - 4 * x + 2;
+                else
+                    return 0;
+            }
+            else if (type == InterpolationType::LANCZOS)
+            {
+                if (x == 0)
+                    return 1;
+                else if (x >= 3)
+                    return 0;
+
+                const float pi_x = float(M_PI) * x;
+                return 3 * std::sin(pi_x) * std::sin(pi_x / 3) / (pi_x * pi_x);
+            }
+            else
+                return x <= 0.5f ? 1 : 0;
+        }
+
+        // for each output pixel, n_taps source indices and normalized weights, out of bounds taps are clamped to the edge
+
+        struct FilterWeights
+        {
+            size_t n_taps = 0;
+            std::vector<size_t> indices;
+            std::vector<float> weights;
+        };
+
+        FilterWeights compute_filter_weights(size_t in_size, size_t out_size, InterpolationType type)
+        {
+            FilterWeights out;
+            const float scale = float(out_size) / float(in_size);
+
+            if (type == InterpolationType::NEAREST or in_size == out_size)
+            {
+                out.n_taps = 1;
+                for (size_t x = 0; x < out_size; ++x)
+                {
+                    out.indices.push_back(std::min<size_t>(in_size - 1, size_t((x + 0.5f) / scale)));
+                    out.weights.push_back(1);
+                }
+                return out;
+            }
+
+            // widen the filter when downscaling, so every source pixel contributes
+
+            const float filter_scale = std::max(1.f, 1.f / scale);
+            const float radius = get_filter_support(type) * filter_scale;
+
+            out.n_taps = 2 * size_t(std::ceil(radius)) + 1;
+            out.indices.resize(out_size * out.n_taps);
+            out.weights.resize(out_size * out.n_taps);
+
+            for (size_t x = 0; x < out_size; ++x)
+            {
+                const float center = (x + 0.5f) / scale;
+                const int64_t first = int64_t(std::floor(center - radius));
+
+                float sum = 0;
+                for (size_t tap = 0; tap < out.n_taps; ++tap)
+                {
+                    const int64_t i = first + int64_t(tap);
+                    const float weight = evaluate_filter(type, (i + 0.5f - center) / filter_scale);
+
+                    out.indices[x * out.n_taps + tap] = std::clamp<int64_t>(i, 0, int64_t(in_size) - 1);
+                    out.weights[x * out.n_taps + tap] = weight;
+                    sum += weight;
+                }
+
+                if (sum != 0)
+                    for (size_t tap = 0; tap < out.n_taps; ++tap)
+                        out.weights[x * out.n_taps + tap] /= sum;
+            }
+
+            return out;
+        }
+
+        void decode_row(const uint8_t* in, float* out, size_t n_pixels, ImageFormat format)
+        {
+            if (format == ImageFormat::RGBA8)
+            {
+                for (size_t i = 0; i < n_pixels * 4; ++i)
+                    out[i] = in[i] * (1.f / 255.f);
+            }
+            else if (format == ImageFormat::RGBA32F)
+                std::memcpy(out, in, n_pixels * 4 * sizeof(float));
+            else
+            {
+                for (size_t i = 0; i < n_pixels; ++i)
+                {
+                    auto color = decode_pixel(in + i * 8, format);
+                    out[i * 4 + 0] = color.r;
+                    out[i * 4 + 1] = color.g;
+                    out[i * 4 + 2] = color.b;
+                    out[i * 4 + 3] = color.a;
+                }
+            }
+        }
+
+        void encode_row(const float* in, uint8_t* out, size_t n_pixels, ImageFormat format)
+        {
+            if (format == ImageFormat::RGBA8)
+            {
+                for (size_t i = 0; i < n_pixels * 4; ++i)
+                    out[i] = uint8_t(std::clamp(in[i], 0.f, 1.f) * 255.f + 0.5f);
+            }
+            else if (format == ImageFormat::RGBA32F)
+                std::memcpy(out, in, n_pixels * 4 * sizeof(float));
+            else
+            {
+                for (size_t i = 0; i < n_pixels; ++i)
+                    encode_pixel(out + i * 8, format, RGBA(in[i * 4 + 0], in[i * 4 + 1], in[i * 4 + 2], in[i * 4 + 3]));
+            }
+        }
+
+        // out[i] = sum_tap weight * in[index], for one row of rgba floats
+
+        void resample_row(const float* in, float* out, const FilterWeights& filter, size_t n_pixels)
+        {
+            for (size_t x = 0; x < n_pixels; ++x)
+            {
+                const size_t* indices = filter.indices.data() + x * filter.n_taps;
+                const float* weights = filter.weights.data() + x * filter.n_taps;
+
+                #if defined(__SSE2__)
+                    auto sum = _mm_setzero_ps();
+                    for (size_t tap = 0; tap < filter.n_taps; ++tap)
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tap]), _mm_loadu_ps(in + indices[tap] * 4)));
+
+                    _mm_storeu_ps(out + x * 4, sum);
+                #else
+                    float sum[4] = {0, 0, 0, 0};
+                    for (size_t tap = 0; tap < filter.n_taps; ++tap)
+                        for (size_t c = 0; c < 4; ++c)
+                            sum[c] += weights[tap] * in[indices[tap] * 4 + c];
+
+                    std::memcpy(out + x * 4, sum, sizeof(sum));
+                #endif
+            }
+        }
+
+        // out[i] += weight * in[i]
+
+        void accumulate_row(const float* in, float* out, float weight, size_t n)
+        {
+            size_t i = 0;
+
+            #if defined(__AVX__)
+                const auto w = _mm256_set1_ps(weight);
+                for (; i + 8 <= n; i += 8)
+                    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(w, _mm256_loadu_ps(in + i))));
+            #elif defined(__SSE2__)
+                const auto w = _mm_set1_ps(weight);
+                for (; i + 4 <= n; i += 4)
+                    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(w, _mm_loadu_ps(in + i))));
+            #endif
+
+            for (; i < n; ++i)
+                out[i] += weight * in[i];
+        }
+    }
+
+    Image::Image(const Image& other)
+    {
+        _data = other._data;
         _size = other._size;
+        _format = other._format;
     }
 
     Image::Image(Image&& other)
     {
-        _data = std::vector<float>();
-        _data.reserve(other._data.size());
-        for (auto v : other._data)
-            _data.push_back(v);
-
+        _data = std::move(other._data);
         _size = other._size;
+        _format = other._format;
 
-        other._data.clear();
         other._size = {0, 0};
     }
 
     Image& Image::operator=(const Image& other)
     {
-        _data = std::vector<float>();
-        _data.reserve(other._data.size());
-        for (auto v : other._data)
-            _data.push_back(v);
+        if (this == &other)
+            return *this;
 
+        _data = other._data;
         _size = other._size;
+        _format = other._format;
 
         return *this;
     }
 
     Image& Image::operator=(Image&& other)
     {
-        _data = std::vector<float>();
-        _data.reserve(other._data.size());
-        for (auto v : other._data)
-            _data.push_back(v);
+        if (this == &other)
+            return *this;
 
+        _data = std::move(other._data);
         _size = other._size;
+        _format = other._format;
 
-        other._data.clear();
         other._size = {0, 0};
 
         return *this;
     }
 
-    void Image::create(size_t width, size_t height, RGBA default_color)
+    void Image::allocate(size_t n_bytes)
     {
-        _data.clear();
-        _data.reserve(width * height * 4);
-        for (size_t i = 0; i < width * height; ++i)
-        {
-            _data.push_back(default_color.r);
-            _data.push_back(default_color.g);
-            _data.push_back(default_color.b);
-            _data.push_back(default_color.a);
-        }
+        // reuse the buffer if no other image shares it
+
+        if (_data != nullptr and _data.use_count() == 1)
+            _data->resize(n_bytes);
+        else
+            _data = std::make_shared<std::vector<uint8_t>>(n_bytes);
+    }
+
+    void Image::detach()
+    {
+        if (_data != nullptr and _data.use_count() > 1)
+            _data = std::make_shared<std::vector<uint8_t>>(*_data);
+    }
+
+    bool Image::is_shared() const
+    {
+        return _data != nullptr and _data.use_count() > 1;
+    }
+
+    uint8_t* Image::bytes()
+    {
+        return _data != nullptr ? _data->data() : nullptr;
+    }
+
+    const uint8_t* Image::bytes() const
+    {
+        return _data != nullptr ? _data->data() : nullptr;
+    }
+
+    void Image::write_pixel(size_t i, RGBA color)
+    {
+        encode_pixel(_data->data() + i, _format, color);
+    }
 
+    RGBA Image::read_pixel(size_t i) const
+    {
+        return decode_pixel(_data->data() + i, _format);
+    }
+
+    void Image::create(size_t width, size_t height, RGBA default_color, ImageFormat format)
+    {
+        _format = format;
         _size = {width, height};
+
+        const auto stride = get_bytes_per_pixel(_format);
+        allocate(width * height * stride);
+
+        if (width * height == 0)
+            return;
+
+        // convert once, then replicate the bytes of the first pixel
+
+        auto* data = bytes();
+        write_pixel(0, default_color);
+        for (size_t i = stride; i < _data->size(); i += stride)
+            std::memcpy(data + i, data, stride);
     }
 
     void Image::create_from_pixbuf(GdkPixbuf* pixbuf)
     {
-        unsigned char* buffer = gdk_pixbuf_get_pixels(pixbuf);
+        const uint8_t* buffer = gdk_pixbuf_get_pixels(pixbuf);
 
-        bool has_alpha = gdk_pixbuf_get_has_alpha(pixbuf);
-        size_t padding_bytes = gdk_pixbuf_get_rowstride(pixbuf) / sizeof(unsigned char) - gdk_pixbuf_get_width(pixbuf) * (has_alpha ? 4 : 3);
-        _size = {gdk_pixbuf_get_width(pixbuf) - padding_bytes, gdk_pixbuf_get_height(pixbuf)};
-        size_t n = _size.x * _size.y * (has_alpha ? 4 : 3);
+        const bool has_alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+        const size_t n_channels = gdk_pixbuf_get_n_channels(pixbuf);
+        const size_t row_stride = gdk_pixbuf_get_rowstride(pixbuf);
+        const size_t width = gdk_pixbuf_get_width(pixbuf);
+        const size_t height = gdk_pixbuf_get_height(pixbuf);
 
-        _data.clear();
-        _data.reserve(n);
+        _format = ImageFormat::RGBA8;
+        _size = {width, height};
+        allocate(width * height * 4);
 
-        for (size_t i = 0; i < n; ++i)
+        // pixbuf rows may be padded, so copy row by row
+
+        for (size_t y = 0; y < height; ++y)
         {
-            _data.push_back(buffer[i] / 255.f);
+            const uint8_t* row = buffer + y * row_stride;
+            uint8_t* out = bytes() + y * width * 4;
 
-            if (not has_alpha)
-                _data.push_back(1);
+            if (has_alpha and n_channels == 4)
+                std::memcpy(out, row, width * 4);
+            else
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    out[4 * x + 0] = row[n_channels * x + 0];
+                    out[4 * x + 1] = row[n_channels * x + 1];
+                    out[4 * x + 2] = row[n_channels * x + 2];
+                    out[4 * x + 3] = 255;
+                }
+            }
         }
     }
 
     bool Image::create_from_file(const std::string& path)
     {
+        MOUSETRAP_PROFILE_ZONE("Image::create_from_file");
+
         GError* error_maybe = nullptr;
         auto* pixbuf = gdk_pixbuf_new_from_file(path.c_str(), &error_maybe);
 
         if (error_maybe != nullptr)
         {
             std::cerr << "[WARNING] In Image::create_from_file: unable to open file \"" << path << "\"" << std::endl;
-            _data.clear();
+            _data.reset();
             _size = {0, 0};
             return false;
         }
@@ -121,32 +755,58 @@ namespace mousetrap
         auto* surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,gdk_texture_get_width(texture), gdk_texture_get_height(texture));
         gdk_texture_download(texture,cairo_image_surface_get_data(surface),cairo_image_surface_get_stride(surface));
         auto* data = cairo_image_surface_get_data(surface);
+        const size_t row_stride = cairo_image_surface_get_stride(surface);
 
         create(size.x, size.y);
-        for (size_t i = 0; i < size.x * size.y * 4; i = i + 4)
+        for (size_t y = 0; y < size.y; ++y)
         {
-            guchar b = data[i+0];
-            guchar g = data[i+1];
-            guchar r = data[i+2];
-            guchar a = data[i+3];
-
-            _data[i+0] = float(r) / 255.f;
-            _data[i+1] = float(g) / 255.f;
-            _data[i+2] = float(b) / 255.f;
-            _data[i+3] = float(a) / 255.f;
+            const guchar* row = data + y * row_stride;
+            uint8_t* out = bytes() + y * size.x * 4;
+
+            for (size_t x = 0; x < size.x; ++x)
+            {
+                out[4 * x + 0] = row[4 * x + 2];
+                out[4 * x + 1] = row[4 * x + 1];
+                out[4 * x + 2] = row[4 * x + 0];
+                out[4 * x + 3] = row[4 * x + 3];
+            }
         }
 
-        cairo_surface_mark_dirty(surface);
-        g_free(surface);
+        cairo_surface_destroy(surface);
     }
 
     GdkPixbuf* Image::to_pixbuf() const
     {
+        if (_format != ImageFormat::RGBA8)
+            return as_format(ImageFormat::RGBA8).to_pixbuf();
+
         auto* out = gdk_pixbuf_new(GDK_COLORSPACE_RGB, true, 8, _size.x, _size.y);
         auto* data = gdk_pixbuf_get_pixels(out);
+        const size_t row_stride = gdk_pixbuf_get_rowstride(out);
+
+        for (size_t y = 0; y < size_t(_size.y); ++y)
+            std::memcpy(data + y * row_stride, bytes() + y * _size.x * 4, _size.x * 4);
+
+        return out;
+    }
+
+    ImageFormat Image::get_format() const
+    {
+        return _format;
+    }
 
-        for (size_t i = 0; i < _data.size(); ++i)
-            data[i] = uint8_t(_data.at(i) * 255.f);
+    Image Image::as_format(ImageFormat format) const
+    {
+        if (format == _format)
+            return *this;
+
+        auto out = Image();
+        out.create(_size.x, _size.y, RGBA(0, 0, 0, 0), format);
+
+        const auto in_stride = get_bytes_per_pixel(_format);
+        const auto out_stride = get_bytes_per_pixel(format);
+        for (size_t i = 0; i < get_n_pixels(); ++i)
+            out.write_pixel(i * out_stride, read_pixel(i * in_stride));
 
         return out;
     }
@@ -177,14 +837,20 @@ namespace mousetrap
         return _size;
     }
 
-    void* Image::data() const
+    void* Image::data()
+    {
+        detach();
+        return bytes();
+    }
+
+    const void* Image::data() const
     {
-        return (void*) _data.data();
+        return bytes();
     }
 
     size_t Image::get_data_size() const
     {
-        return _data.size();
+        return _data != nullptr ? _data->size() : 0;
     }
 
     size_t Image::get_n_pixels() const
@@ -194,23 +860,19 @@ namespace mousetrap
 
     size_t Image::to_linear_index(size_t x, size_t y) const
     {
-        return y * (_size.x * 4) + (x * 4);
+        return (y * _size.x + x) * get_bytes_per_pixel(_format);
     }
 
     void Image::set_pixel(size_t x, size_t y, RGBA color)
     {
-        auto i = to_linear_index(x, y);
-
-        if (i >= _data.size())
+        if (x >= size_t(_size.x) or y >= size_t(_size.y))
         {
             std::cerr << "[ERROR] In Image::set_pixel: indices " << x << " " << y << " are out of bounds for an image of size " << _size.x << "x" << _size.y << std::endl;
             return;
         }
 
-        _data.at(i) = color.r;
-        _data.at(i+1) = color.g;
-        _data.at(i+2) = color.b;
-        _data.at(i+3) = color.a;
+        detach();
+        write_pixel(to_linear_index(x, y), color);
     }
 
     void Image::set_pixel(size_t x, size_t y, HSVA color)
@@ -220,92 +882,136 @@ namespace mousetrap
 
     RGBA Image::get_pixel(size_t x, size_t y) const
     {
-        auto i = to_linear_index(x, y);
-
-        if (i >= _data.size())
+        if (x >= size_t(_size.x) or y >= size_t(_size.y))
         {
             std::cerr << "[ERROR] In Image::get_pixel: indices " << x << " " << y << " are out of bounds for an image of size " << _size.x << "x" << _size.y << std::endl;
             return RGBA(0, 0, 0, 0);
         }
 
-        return RGBA
-        (
-        _data.at(i),
-        _data.at(i+1),
-        _data.at(i+2),
-        _data.at(i+3)
-        );
+        return read_pixel(to_linear_index(x, y));
     }
 
     void Image::set_pixel(size_t i, RGBA color)
     {
-        i *= 4;
-
-        if (i >= _data.size())
+        if (i >= get_n_pixels())
         {
-            std::cerr << "[ERROR] In Image::set_pixel: index " << i / 4 << " out of bounds for an image of with " << _size.x * _size.y << " pixels" << std::endl;
+            std::cerr << "[ERROR] In Image::set_pixel: index " << i << " out of bounds for an image of with " << _size.x * _size.y << " pixels" << std::endl;
             return;
         }
 
-        _data.at(i) = color.r;
-        _data.at(i+1) = color.g;
-        _data.at(i+2) = color.b;
-        _data.at(i+3) = color.a;
+        detach();
+        write_pixel(i * get_bytes_per_pixel(_format), color);
     }
 
-    void Image::set_pixel(size_t i, HSVA color_hsva)
+    void Image::set_pixel(size_t i, HSVA color)
     {
-        auto color = color_hsva.operator RGBA();
-
-        i *= 4;
-
-        if (i >= _data.size())
-        {
-            std::cerr << "[ERROR] In Image::set_pixel: index " << i / 4 << " out of bounds for an image of with " << _size.x * _size.y << " pixels" << std::endl;
-            RGBA(0, 0, 0, 0);
-        }
-
-        _data.at(i) = color.r;
-        _data.at(i+1) = color.g;
-        _data.at(i+2) = color.b;
-        _data.at(i+3) = color.a;
+        set_pixel(i, color.operator RGBA());
     }
 
     RGBA Image::get_pixel(size_t i) const
     {
-        i *= 4;
+        if (i >= get_n_pixels())
+        {
+            std::cerr << "[ERROR] In Image::get_pixel: index " << i << " out of bounds for an image of with " << _size.x * _size.y << " pixels" << std::endl;
+            return RGBA(0, 0, 0, 0);
+        }
 
-        return RGBA
-        (
-        _data.at(i),
-        _data.at(i+1),
-        _data.at(i+2),
-        _data.at(i+3)
-        );
+        return read_pixel(i * get_bytes_per_pixel(_format));
     }
 
     Image Image::as_cropped(int offset_x, int offset_y, size_t size_x, size_t size_y) const
     {
+        // pixel (x, y) of the result is pixel (x - offset_x, y - offset_y) of this image, transparent if outside
+
         auto out = Image();
-        out.create(size_x, size_y);
+        out.create(size_x, size_y, RGBA(0, 0, 0, 0), _format);
+        out.blit(view(), {offset_x, offset_y});
+        return out;
+    }
 
-        for (size_t y = 0; y < size_y; ++y)
+    void Image::blit(const ImageView& source, Vector2i position, bool alpha_blend)
+    {
+        if (source.get_format() != _format)
         {
-            for (size_t x = 0; x < size_x; ++x)
+            blit(source.to_image().as_format(_format).view(), position, alpha_blend);
+            return;
+        }
+
+        const int64_t x0 = std::max<int64_t>(0, position.x);
+        const int64_t y0 = std::max<int64_t>(0, position.y);
+        const int64_t x1 = std::min<int64_t>(_size.x, position.x + int64_t(source.get_size().x));
+        const int64_t y1 = std::min<int64_t>(_size.y, position.y + int64_t(source.get_size().y));
+
+        if (x1 <= x0 or y1 <= y0)
+            return;
+
+        detach();
+
+        const size_t bytes_per_pixel = get_bytes_per_pixel(_format);
+        const size_t n_pixels = x1 - x0;
+        const size_t n_rows = y1 - y0;
+        uint8_t* destination = bytes();
+
+        for_each_row_band(n_rows, n_rows * n_pixels * bytes_per_pixel, [&](size_t begin, size_t end){
+            for (size_t row = begin; row < end; ++row)
             {
-                Vector2i pos = {x - offset_x, y - offset_y};
+                const auto* in = static_cast<const uint8_t*>(source.get_row(y0 + row - position.y)) + (x0 - position.x) * bytes_per_pixel;
+                auto* out = destination + ((y0 + row) * _size.x + x0) * bytes_per_pixel;
 
-                if (pos.x < 0 or pos.x >= get_size().x or pos.y < 0 or pos.y >= get_size().y)
-                    out.set_pixel(x, y, RGBA(0, 0, 0, 0));
+                if (not alpha_blend)
+                    std::memmove(out, in, n_pixels * bytes_per_pixel);
+                else if (_format == ImageFormat::RGBA8)
+                    blend_pixels_rgba8(in, out, n_pixels);
                 else
-                    out.set_pixel(x, y, get_pixel(pos.x, pos.y));
+                {
+                    for (size_t i = 0; i < n_pixels; ++i)
+                    {
+                        auto s = decode_pixel(in + i * bytes_per_pixel, _format);
+                        auto d = decode_pixel(out + i * bytes_per_pixel, _format);
+                        encode_pixel(out + i * bytes_per_pixel, _format, RGBA(
+                            s.a * s.r + (1 - s.a) * d.r,
+                            s.a * s.g + (1 - s.a) * d.g,
+                            s.a * s.b + (1 - s.a) * d.b,
+                            s.a + (1 - s.a) * d.a
+                        ));
+                    }
+                }
             }
-        }
+        });
+    }
+
+    ImageView Image::view() const
+    {
+        return view(0, 0, _size.x, _size.y);
+    }
+
+    ImageView Image::view(size_t offset_x, size_t offset_y, size_t width, size_t height) const
+    {
+        ImageView out;
+        out._format = _format;
+        out._row_stride = _size.x * get_bytes_per_pixel(_format);
+
+        offset_x = std::min<size_t>(offset_x, _size.x);
+        offset_y = std::min<size_t>(offset_y, _size.y);
+        out._size = {std::min<size_t>(width, _size.x - offset_x), std::min<size_t>(height, _size.y - offset_y)};
+
+        if (out._size.x != 0 and out._size.y != 0)
+            out._data = bytes() + offset_y * out._row_stride + offset_x * get_bytes_per_pixel(_format);
 
         return out;
     }
 
-    Image Image::as_scaled(size_t size_x, size_t size_y, GdkInterpType interpolation_type) const
+    Image Image::as_scaled(size_t size_x, size_t size_y, GdkInterpType type) const
+    {
+        if (type == GDK_INTERP_NEAREST)
+            return as_scaled(size_x, size_y, InterpolationType::NEAREST);
+        else if (type == GDK_INTERP_HYPER)
+            return as_scaled(size_x, size_y, InterpolationType::BICUBIC);
+        else
+            return as_scaled(size_x, size_y, InterpolationType::BILINEAR);
+    }
+
+    Image Image::as_scaled(size_t size_x, size_t size_y, InterpolationType type) const
     {
         if (int(size_x) == _size.x and int(size_y) == _size.y)
             return *this;
@@ -316,14 +1022,54 @@ namespace mousetrap
         if (size_y == size_t(0))
             size_y = 1;
 
-        GdkPixbuf* unscaled = g_object_ref(to_pixbuf());
-        auto scaled = g_object_ref(gdk_pixbuf_scale_simple(unscaled, size_x, size_y, interpolation_type));
-
         auto out = Image();
-        out.create_from_pixbuf(scaled);
+        out._format = _format;
+        out._size = {size_x, size_y};
+        out.allocate(size_x * size_y * get_bytes_per_pixel(_format));
 
-        g_object_unref(unscaled);
-        g_object_unref(scaled);
+        if (get_n_pixels() == 0)
+            return out;
+
+        // separable: scale rows into a float buffer, then combine rows of that buffer
+
+        const size_t in_width = _size.x;
+        const size_t in_height = _size.y;
+        const size_t bytes_per_pixel = get_bytes_per_pixel(_format);
+
+        const auto horizontal = compute_filter_weights(in_width, size_x, type);
+        const auto vertical = compute_filter_weights(in_height, size_y, type);
+
+        std::vector<float> intermediate(size_x * in_height * 4);
+        const uint8_t* source = bytes();
+
+        for_each_row_band(in_height, in_height * size_x * 4 * sizeof(float), [&](size_t begin, size_t end){
+            std::vector<float> row(in_width * 4);
+            for (size_t y = begin; y < end; ++y)
+            {
+                decode_row(source + y * in_width * bytes_per_pixel, row.data(), in_width, _format);
+                resample_row(row.data(), intermediate.data() + y * size_x * 4, horizontal, size_x);
+            }
+        });
+
+        uint8_t* destination = out.bytes();
+
+        for_each_row_band(size_y, size_y * size_x * 4 * sizeof(float), [&](size_t begin, size_t end){
+            std::vector<float> row(size_x * 4);
+            for (size_t y = begin; y < end; ++y)
+            {
+                std::fill(row.begin(), row.end(), 0.f);
+                for (size_t tap = 0; tap < vertical.n_taps; ++tap)
+                {
+                    const size_t index = vertical.indices[y * vertical.n_taps + tap];
+                    const float weight = vertical.weights[y * vertical.n_taps + tap];
+
+                    if (weight != 0)
+                        accumulate_row(intermediate.data() + index * size_x * 4, row.data(), weight, size_x * 4);
+                }
+
+                encode_row(row.data(), destination + y * size_x * bytes_per_pixel, size_x, _format);
+            }
+        });
 
         return out;
     }
@@ -331,24 +1077,159 @@ namespace mousetrap
     Image Image::as_flipped(bool flip_horizontally, bool flip_vertically) const
     {
         auto out = Image();
-        out.create(_size.x, _size.y);
+        out._format = _format;
+        out._size = _size;
+        out.allocate(get_data_size());
 
-        for (size_t x = 0; x < _size.x; ++x)
-        {
-            for (size_t y = 0; y < _size.y; ++y)
+        const size_t width = _size.x;
+        const size_t height = _size.y;
+        const size_t bytes_per_pixel = get_bytes_per_pixel(_format);
+        const size_t row_size = width * bytes_per_pixel;
+
+        const uint8_t* source = bytes();
+        uint8_t* destination = out.bytes();
+
+        for_each_row_band(height, get_data_size(), [&](size_t begin, size_t end){
+            for (size_t y = begin; y < end; ++y)
             {
-                Vector2ui pos = {x, y};
+                const auto* in = source + (flip_vertically ? height - y - 1 : y) * row_size;
+                auto* out_row = destination + y * row_size;
 
                 if (flip_horizontally)
-                    pos.x = _size.x - pos.x - 1;
+                    reverse_pixels(in, out_row, width, bytes_per_pixel);
+                else
+                    std::memcpy(out_row, in, row_size);
+            }
+        });
 
-                if (flip_vertically)
-                    pos.y = _size.y - pos.y - 1;
+        return out;
+    }
+
+    Image Image::as_downsampled() const
+    {
+        const size_t width = _size.x;
+        const size_t height = _size.y;
+        const size_t out_width = std::max<size_t>(1, width / 2);
+        const size_t out_height = std::max<size_t>(1, height / 2);
+
+        auto out = Image();
+        out.create(out_width, out_height, RGBA(0, 0, 0, 0), _format);
+
+        if (width == 0 or height == 0)
+            return out;
+
+        for (size_t y = 0; y < out_height; ++y)
+        {
+            const size_t y0 = std::min(2 * y, height - 1);
+            const size_t y1 = std::min(2 * y + 1, height - 1);
+
+            for (size_t x = 0; x < out_width; ++x)
+            {
+                const size_t x0 = std::min(2 * x, width - 1);
+                const size_t x1 = std::min(2 * x + 1, width - 1);
+
+                if (_format == ImageFormat::RGBA8)
+                {
+                    // integer average with rounding, avoids converting to float per channel
+
+                    const auto* row_0 = bytes() + y0 * width * 4;
+                    const auto* row_1 = bytes() + y1 * width * 4;
+                    auto* destination = out.bytes() + (y * out_width + x) * 4;
 
-                out.set_pixel(pos.x, pos.y, get_pixel(x, y));
+                    for (size_t c = 0; c < 4; ++c)
+                        destination[c] = (uint32_t(row_0[x0 * 4 + c]) + row_0[x1 * 4 + c] + row_1[x0 * 4 + c] + row_1[x1 * 4 + c] + 2) / 4;
+                }
+                else
+                {
+                    const size_t bpp = get_bytes_per_pixel(_format);
+                    auto a = read_pixel((y0 * width + x0) * bpp);
+                    auto b = read_pixel((y0 * width + x1) * bpp);
+                    auto c = read_pixel((y1 * width + x0) * bpp);
+                    auto d = read_pixel((y1 * width + x1) * bpp);
+
+                    out.write_pixel((y * out_width + x) * bpp, RGBA(
+                        (a.r + b.r + c.r + d.r) / 4,
+                        (a.g + b.g + c.g + d.g) / 4,
+                        (a.b + b.b + c.b + d.b) / 4,
+                        (a.a + b.a + c.a + d.a) / 4
+                    ));
+                }
             }
         }
 
         return out;
     }
-}
\ No newline at end of file
+
+    std::vector<Image> Image::create_mipmap_chain() const
+    {
+        std::vector<Image> out;
+        out.push_back(*this);
+
+        while (out.back().get_size().x > 1 or out.back().get_size().y > 1)
+            out.push_back(out.back().as_downsampled());
+
+        return out;
+    }
+
+    Vector2ui ImageView::get_size() const
+    {
+        return _size;
+    }
+
+    ImageFormat ImageView::get_format() const
+    {
+        return _format;
+    }
+
+    size_t ImageView::get_row_stride() const
+    {
+        return _row_stride;
+    }
+
+    const void* ImageView::get_row(size_t y) const
+    {
+        return _data + y * _row_stride;
+    }
+
+    RGBA ImageView::get_pixel(size_t x, size_t y) const
+    {
+        if (x >= _size.x or y >= _size.y)
+        {
+            std::cerr << "[ERROR] In ImageView::get_pixel: indices " << x << " " << y << " are out of bounds for a view of size " << _size.x << "x" << _size.y << std::endl;
+            return RGBA(0, 0, 0, 0);
+        }
+
+        return decode_pixel(_data + y * _row_stride + x * get_bytes_per_pixel(_format), _format);
+    }
+
+    ImageView ImageView::view(size_t offset_x, size_t offset_y, size_t width, size_t height) const
+    {
+        ImageView out = *this;
+
+        offset_x = std::min(offset_x, _size.x);
+        offset_y = std::min(offset_y, _size.y);
+        out._size = {std::min(width, _size.x - offset_x), std::min(height, _size.y - offset_y)};
+
+        if (out._size.x != 0 and out._size.y != 0)
+            out._data = _data + offset_y * _row_stride + offset_x * get_bytes_per_pixel(_format);
+        else
+            out._data = nullptr;
+
+        return out;
+    }
+
+    Image ImageView::to_image() const
+    {
+        auto out = Image();
+        out._format = _format;
+        out._size = {_size.x, _size.y};
+
+        const size_t row_size = _size.x * get_bytes_per_pixel(_format);
+        out.allocate(row_size * _size.y);
+
+        for (size_t y = 0; y < _size.y; ++y)
+            std::memcpy(out.bytes() + y * row_size, _data + y * _row_stride, row_size);
+
+        return out;
+    }
+}
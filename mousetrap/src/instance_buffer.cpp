@@ -0,0 +1,136 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/instance_buffer.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+namespace mousetrap
+{
+    InstanceBuffer::InstanceBuffer()
+    {
+        glGenBuffers(1, &_buffer_id);
+    }
+
+    InstanceBuffer::~InstanceBuffer()
+    {
+        if (_buffer_id != 0)
+            glDeleteBuffers(1, &_buffer_id);
+    }
+
+    void InstanceBuffer::create(size_t n_instances)
+    {
+        _instance_data.clear();
+        _instance_data.resize(n_instances, InstanceInfo{
+            {1, 0, 0},
+            {0, 1, 0},
+            {1, 1, 1, 1}
+        });
+
+        _reallocate = true;
+    }
+
+    size_t InstanceBuffer::get_n_instances() const
+    {
+        return _instance_data.size();
+    }
+
+    void InstanceBuffer::set_instance(size_t i, GLTransform transform, RGBA tint)
+    {
+        if (i >= _instance_data.size())
+        {
+            std::cerr << "[ERROR] In InstanceBuffer::set_instance: index " << i << " out of bounds for a buffer with " << _instance_data.size() << " instances" << std::endl;
+            return;
+        }
+
+        set_instance_transform(i, transform);
+        set_instance_color(i, tint);
+    }
+
+    void InstanceBuffer::set_instance_transform(size_t i, GLTransform transform)
+    {
+        if (i >= _instance_data.size())
+        {
+            std::cerr << "[ERROR] In InstanceBuffer::set_instance_transform: index " << i << " out of bounds for a buffer with " << _instance_data.size() << " instances" << std::endl;
+            return;
+        }
+
+        // x' = m00 * x + m10 * y + m30, y' = m01 * x + m11 * y + m31
+
+        const auto& m = transform.transform;
+        auto& data = _instance_data[i];
+
+        data._transform_row_0[0] = m[0][0];
+        data._transform_row_0[1] = m[1][0];
+        data._transform_row_0[2] = m[3][0];
+
+        data._transform_row_1[0] = m[0][1];
+        data._transform_row_1[1] = m[1][1];
+        data._transform_row_1[2] = m[3][1];
+
+        mark_dirty(i, i+1);
+    }
+
+    void InstanceBuffer::set_instance_color(size_t i, RGBA color)
+    {
+        if (i >= _instance_data.size())
+        {
+            std::cerr << "[ERROR] In InstanceBuffer::set_instance_color: index " << i << " out of bounds for a buffer with " << _instance_data.size() << " instances" << std::endl;
+            return;
+        }
+
+        auto& data = _instance_data[i];
+        data._color[0] = color.r;
+        data._color[1] = color.g;
+        data._color[2] = color.b;
+        data._color[3] = color.a;
+
+        mark_dirty(i, i+1);
+    }
+
+    RGBA InstanceBuffer::get_instance_color(size_t i) const
+    {
+        const auto& data = _instance_data.at(i);
+        return RGBA(data._color[0], data._color[1], data._color[2], data._color[3]);
+    }
+
+    void InstanceBuffer::mark_dirty(size_t begin, size_t end)
+    {
+        if (_dirty_begin == _dirty_end)
+        {
+            _dirty_begin = begin;
+            _dirty_end = end;
+        }
+        else
+        {
+            _dirty_begin = std::min(_dirty_begin, begin);
+            _dirty_end = std::max(_dirty_end, end);
+        }
+    }
+
+    void InstanceBuffer::update_data()
+    {
+        if (_reallocate)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, _buffer_id);
+            glBufferData(GL_ARRAY_BUFFER, _instance_data.size() * sizeof(InstanceInfo), _instance_data.data(), GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        else if (_dirty_begin != _dirty_end)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, _buffer_id);
+            glBufferSubData(GL_ARRAY_BUFFER,
+                _dirty_begin * sizeof(InstanceInfo),
+                (_dirty_end - _dirty_begin) * sizeof(InstanceInfo),
+                _instance_data.data() + _dirty_begin
+            );
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        _reallocate = false;
+        _dirty_begin = 0;
+        _dirty_end = 0;
+    }
+}
@@ -0,0 +1,194 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/render_queue.hpp"
+
+#include <array>
+#include <algorithm>
+
+namespace mousetrap
+{
+    uint64_t RenderQueue::compute_key(RenderTask* task, uint8_t layer, float depth)
+    {
+        // [63, 56] layer | [55, 40] program | [39, 24] texture | [23, 20] blend mode | [19, 0] depth
+        // ids are truncated to 16 bits, collisions only make the order less optimal, state is still compared by full id on submit
+
+        uint64_t program = task->get_shader()->get_program_id() & 0xFFFF;
+
+        uint64_t texture = 0;
+        if (task->get_shape() != nullptr and task->get_shape()->get_texture() != nullptr)
+            texture = task->get_shape()->get_texture()->get_native_handle() & 0xFFFF;
+
+        uint64_t blend_mode = uint64_t(task->get_blend_mode()) & 0xF;
+        uint64_t quantized_depth = uint64_t(std::clamp(depth, 0.f, 1.f) * 0xFFFFF);
+
+        return (uint64_t(layer) << 56) | (program << 40) | (texture << 24) | (blend_mode << 20) | quantized_depth;
+    }
+
+    void RenderQueue::push(RenderTask* task, uint8_t layer, float depth)
+    {
+        if (task == nullptr)
+            return;
+
+        _entries.push_back({compute_key(task, layer, depth), task});
+    }
+
+    void RenderQueue::clear()
+    {
+        _entries.clear();
+    }
+
+    void RenderQueue::sort()
+    {
+        // lsd radix sort, 8 bits per pass, stable so tasks with equal keys keep their push order
+
+        _swap.resize(_entries.size());
+
+        for (size_t shift = 0; shift < 64; shift += 8)
+        {
+            std::array<size_t, 256> count = {};
+            for (auto& entry : _entries)
+                count[(entry.key >> shift) & 0xFF] += 1;
+
+            // all keys share this byte, pass would not change the order
+
+            if (std::find(count.begin(), count.end(), _entries.size()) != count.end())
+                continue;
+
+            size_t offset = 0;
+            for (auto& n : count)
+            {
+                auto current = n;
+                n = offset;
+                offset += current;
+            }
+
+            for (auto& entry : _entries)
+                _swap[count[(entry.key >> shift) & 0xFF]++] = entry;
+
+            std::swap(_entries, _swap);
+        }
+    }
+
+    size_t RenderQueue::count_state_changes(const std::vector<Entry>& entries)
+    {
+        // same transitions submit issues, so redundant binds are not counted
+
+        size_t out = 0;
+        bool first = true;
+        GLNativeHandle current_program = 0;
+        GLNativeHandle current_texture = 0;
+        BlendMode current_blend_mode = BlendMode::NORMAL;
+
+        for (auto& entry : entries)
+        {
+            auto* task = entry.task;
+            auto* shape = task->get_shape();
+
+            if (shape == nullptr or not shape->get_visible())
+                continue;
+
+            if (first or task->get_shader()->get_program_id() != current_program)
+            {
+                current_program = task->get_shader()->get_program_id();
+                out += 1;
+            }
+
+            auto* texture = shape->get_texture();
+            if (texture != nullptr and (first or texture->get_native_handle() != current_texture))
+            {
+                current_texture = texture->get_native_handle();
+                out += 1;
+            }
+
+            if (first or task->get_blend_mode() != current_blend_mode)
+            {
+                current_blend_mode = task->get_blend_mode();
+                out += 1;
+            }
+
+            first = false;
+        }
+
+        return out;
+    }
+
+    void RenderQueue::submit()
+    {
+        _statistics = Statistics();
+
+        if (_entries.empty())
+            return;
+
+        // entries are still in push order here
+        const size_t n_unsorted = count_state_changes(_entries);
+
+        sort();
+
+        bool first = true;
+        GLNativeHandle current_program = 0;
+        GLNativeHandle current_texture = 0;
+        BlendMode current_blend_mode = BlendMode::NORMAL;
+
+        for (auto& entry : _entries)
+        {
+            auto* task = entry.task;
+            auto* shape = task->get_shape();
+
+            if (shape == nullptr or not shape->get_visible())
+                continue;
+
+            auto* shader = task->get_shader();
+            auto* transform = task->get_transform();
+
+            if (first or shader->get_program_id() != current_program)
+            {
+                current_program = shader->get_program_id();
+                GLStateCache::use_program(current_program);
+                _statistics.n_program_changes += 1;
+            }
+
+            auto* texture = shape->get_texture();
+            if (texture != nullptr and (first or texture->get_native_handle() != current_texture))
+            {
+                current_texture = texture->get_native_handle();
+                texture->bind();
+                _statistics.n_texture_changes += 1;
+            }
+
+            if (first or task->get_blend_mode() != current_blend_mode)
+            {
+                current_blend_mode = task->get_blend_mode();
+                set_current_blend_mode(current_blend_mode);
+                _statistics.n_blend_mode_changes += 1;
+            }
+
+            first = false;
+            _statistics.n_tasks += 1;
+
+            if (not task->_profiling_name.empty())
+                GPUProfiler::begin_zone(task->_profiling_name);
+
+            task->set_registered_uniforms(*shader);
+
+            if (task->get_instances() != nullptr)
+                shape->draw_instanced(*shader, *transform, *task->get_instances());
+            else
+                shape->draw(*shader, *transform);
+
+            if (not task->_profiling_name.empty())
+                GPUProfiler::end_zone();
+        }
+
+        size_t n_sorted = _statistics.n_program_changes + _statistics.n_texture_changes + _statistics.n_blend_mode_changes;
+        _statistics.n_state_changes_saved = n_unsorted > n_sorted ? n_unsorted - n_sorted : 0;
+
+        _entries.clear();
+    }
+
+    RenderQueue::Statistics RenderQueue::get_statistics() const
+    {
+        return _statistics;
+    }
+}
@@ -4,6 +4,7 @@
 //
 
 #include "mousetrap/include/render_task.hpp"
+#include "mousetrap/include/cpu_profiler.hpp"
 
 namespace mousetrap
 {
@@ -23,140 +24,202 @@ namespace mousetrap
 
     void RenderTask::render()
     {
+        MOUSETRAP_PROFILE_ZONE("RenderTask::render");
+
         if (_shape == nullptr)
             return;
 
-        auto* shader = _shader == nullptr ? noop_shader : _shader;
+        auto* shader = get_shader();
         auto* transform = _transform == nullptr ? noop_transform : _transform;
 
-        glUseProgram(shader->get_program_id());
+        if (not _profiling_name.empty())
+            GPUProfiler::begin_zone(_profiling_name);
 
-        for (auto& pair : _floats)
-            if (pair.second != nullptr)
-                shader->set_uniform_float(pair.first, *pair.second);
+        GLStateCache::use_program(shader->get_program_id());
+        set_registered_uniforms(*shader);
 
-        for (auto& pair : _ints)
-            if (pair.second != nullptr)
-                shader->set_uniform_int(pair.first, *pair.second);
+        set_current_blend_mode(_blend_mode);
 
-        for (auto& pair : _vec2s)
-            if (pair.second != nullptr)
-                shader->set_uniform_vec2(pair.first, *pair.second);
+        if (_instances != nullptr)
+            _shape->render_instanced(*shader, *transform, *_instances);
+        else
+            _shape->render(*shader, *transform);
 
-        for (auto& pair : _vec3s)
-            if (pair.second != nullptr)
-                shader->set_uniform_vec3(pair.first, *pair.second);
+        if (not _profiling_name.empty())
+            GPUProfiler::end_zone();
+    }
 
-        for (auto& pair : _vec4s)
-            if (pair.second != nullptr)
-                shader->set_uniform_vec4(pair.first, *pair.second);
+    void RenderTask::resolve_uniform_locations(Shader& shader)
+    {
+        for (auto& binding : _uniforms)
+        {
+            if (binding.type == UniformType::BLOCK)
+                binding.location = shader.get_uniform_block_index(binding.name);
+            else
+                binding.location = shader.get_uniform_location(binding.name);
+        }
+
+        _resolved_program_id = shader.get_program_id();
+    }
 
-        for (auto& pair : _transforms)
-            if (pair.second != nullptr)
-                shader->set_uniform_transform(pair.first, *pair.second);
+    void RenderTask::set_registered_uniforms(Shader& shader)
+    {
+        // program id changes when the shader is relinked
+
+        if (shader.get_program_id() != _resolved_program_id)
+            resolve_uniform_locations(shader);
+
+        for (auto& binding : _uniforms)
+        {
+            if (binding.value == nullptr or binding.location == -1)
+                continue;
+
+            switch (binding.type)
+            {
+                case UniformType::FLOAT:
+                    shader.set_uniform_float(binding.location, *static_cast<const float*>(binding.value));
+                    break;
+                case UniformType::INT:
+                    shader.set_uniform_int(binding.location, *static_cast<const int*>(binding.value));
+                    break;
+                case UniformType::UINT:
+                    shader.set_uniform_uint(binding.location, *static_cast<const glm::uint*>(binding.value));
+                    break;
+                case UniformType::VEC2:
+                    shader.set_uniform_vec2(binding.location, *static_cast<const Vector2f*>(binding.value));
+                    break;
+                case UniformType::VEC3:
+                    shader.set_uniform_vec3(binding.location, *static_cast<const Vector3f*>(binding.value));
+                    break;
+                case UniformType::VEC4:
+                    shader.set_uniform_vec4(binding.location, *static_cast<const Vector4f*>(binding.value));
+                    break;
+                case UniformType::TRANSFORM:
+                    shader.set_uniform_transform(binding.location, *static_cast<const GLTransform*>(binding.value));
+                    break;
+                case UniformType::COLOR_RGBA:
+                    shader.set_uniform_vec4(binding.location, static_cast<const RGBA*>(binding.value)->operator glm::vec4());
+                    break;
+                case UniformType::COLOR_HSVA:
+                    shader.set_uniform_vec4(binding.location, static_cast<const HSVA*>(binding.value)->operator glm::vec4());
+                    break;
+                case UniformType::BLOCK:
+                {
+                    // value is only const for storage, binding uploads pending changes
+                    auto* buffer = static_cast<UniformBufferObject*>(const_cast<void*>(binding.value));
+                    buffer->bind();
+                    shader.bind_uniform_block(binding.location, buffer->get_binding_point());
+                    break;
+                }
+            }
+        }
+    }
 
-        for (auto& pair : _colors_rgba)
-            if (pair.second != nullptr)
-                shader->set_uniform_vec4(pair.first, pair.second->operator glm::vec4());
+    void RenderTask::add_binding(const std::string& uniform_name, UniformType type, const void* value)
+    {
+        for (auto& binding : _uniforms)
+            if (binding.name == uniform_name and binding.type == type)
+                return;
 
-        for (auto& pair : _colors_hsva)
-            if (pair.second != nullptr)
-                shader->set_uniform_vec4(pair.first, pair.second->operator glm::vec4());
+        _uniforms.push_back({uniform_name, type, value});
 
-        glEnable(GL_BLEND);
-        set_current_blend_mode(_blend_mode);
-        _shape->render(*shader, *transform);
-        set_current_blend_mode(BlendMode::NORMAL);
+        // force resolve on next render
+        _resolved_program_id = 0;
     }
 
     void RenderTask::register_float(const std::string& uniform_name, float* value)
     {
-        _floats.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::FLOAT, value);
     }
 
     void RenderTask::register_int(const std::string& uniform_name, int* value)
     {
-        _ints.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::INT, value);
     }
 
     void RenderTask::register_uint(const std::string& uniform_name, glm::uint* value)
     {
-        _uints.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::UINT, value);
     }
 
     void RenderTask::register_vec2(const std::string& uniform_name, Vector2f* value)
     {
-        _vec2s.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::VEC2, value);
     }
 
     void RenderTask::register_vec3(const std::string& uniform_name, Vector3f* value)
     {
-        _vec3s.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::VEC3, value);
     }
 
     void RenderTask::register_vec4(const std::string& uniform_name, Vector4f* value)
     {
-        _vec4s.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::VEC4, value);
     }
 
     void RenderTask::register_transform(const std::string& uniform_name, GLTransform* value)
     {
-        _transforms.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::TRANSFORM, value);
     }
 
     void RenderTask::register_color(const std::string& uniform_name, RGBA* value)
     {
-        _colors_rgba.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::COLOR_RGBA, value);
     }
 
     void RenderTask::register_color(const std::string& uniform_name, HSVA* value)
     {
-        _colors_hsva.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::COLOR_HSVA, value);
     }
 
     void RenderTask::register_float(const std::string& uniform_name, const float* value)
     {
-        _floats.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::FLOAT, value);
     }
 
     void RenderTask::register_int(const std::string& uniform_name, const int* value)
     {
-        _ints.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::INT, value);
     }
 
     void RenderTask::register_uint(const std::string& uniform_name, const glm::uint* value)
     {
-        _uints.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::UINT, value);
     }
 
     void RenderTask::register_vec2(const std::string& uniform_name, const Vector2f* value)
     {
-        _vec2s.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::VEC2, value);
     }
 
     void RenderTask::register_vec3(const std::string& uniform_name, const Vector3f* value)
     {
-        _vec3s.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::VEC3, value);
     }
 
     void RenderTask::register_vec4(const std::string& uniform_name, const Vector4f* value)
     {
-        _vec4s.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::VEC4, value);
     }
 
     void RenderTask::register_transform(const std::string& uniform_name, const GLTransform* value)
     {
-        _transforms.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::TRANSFORM, value);
     }
 
     void RenderTask::register_color(const std::string& uniform_name, const RGBA* value)
     {
-        _colors_rgba.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::COLOR_RGBA, value);
     }
 
     void RenderTask::register_color(const std::string& uniform_name, const HSVA* value)
     {
-        _colors_hsva.insert({uniform_name, value});
+        add_binding(uniform_name, UniformType::COLOR_HSVA, value);
+    }
+
+    void RenderTask::register_uniform_buffer(const std::string& block_name, UniformBufferObject* buffer)
+    {
+        add_binding(block_name, UniformType::BLOCK, buffer);
     }
 
     Shape* RenderTask::get_shape()
@@ -166,11 +229,50 @@ namespace mousetrap
 
     Shader* RenderTask::get_shader()
     {
-        return _shader == nullptr ? noop_shader : _shader;
+        if (_shader != nullptr)
+            return _shader;
+
+        if (_instances != nullptr)
+        {
+            if (noop_instanced_shader == nullptr)
+            {
+                noop_instanced_shader = new Shader();
+                noop_instanced_shader->create_from_string(Shader::get_noop_instanced_vertex_shader_source(), ShaderType::VERTEX);
+            }
+
+            return noop_instanced_shader;
+        }
+
+        return noop_shader;
+    }
+
+    void RenderTask::set_instances(InstanceBuffer* instances)
+    {
+        _instances = instances;
+    }
+
+    InstanceBuffer* RenderTask::get_instances()
+    {
+        return _instances;
+    }
+
+    BlendMode RenderTask::get_blend_mode() const
+    {
+        return _blend_mode;
     }
 
     GLTransform* RenderTask::get_transform()
     {
         return _transform == nullptr ? noop_transform : _transform;
     }
-}
\ No newline at end of file
+
+    void RenderTask::set_profiling_name(const std::string& name)
+    {
+        _profiling_name = name;
+    }
+
+    const std::string& RenderTask::get_profiling_name() const
+    {
+        return _profiling_name;
+    }
+}
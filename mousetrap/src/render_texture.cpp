@@ -6,24 +6,29 @@ namespace mousetrap
         : Texture()
     {
         glGenFramebuffers(1, &_framebuffer_handle);
-        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_handle);
+        GLStateCache::bind_framebuffer(_framebuffer_handle);
     }
 
     RenderTexture::~RenderTexture()
     {
         if (_framebuffer_handle != 0)
+        {
+            GLStateCache::on_framebuffer_deleted(_framebuffer_handle);
             glDeleteFramebuffers(1, &_framebuffer_handle);
+        }
     }
 
     RenderTexture::RenderTexture(RenderTexture&& other)
     {
         this->_framebuffer_handle = other._framebuffer_handle;
+        this->_profiling_name = other._profiling_name;
         other._framebuffer_handle = 0;
     }
 
     RenderTexture& RenderTexture::operator=(RenderTexture&& other)
     {
         this->_framebuffer_handle = other._framebuffer_handle;
+        this->_profiling_name = other._profiling_name;
         other._framebuffer_handle = 0;
         return *this;
     }
@@ -32,16 +37,26 @@ namespace mousetrap
     {
         constexpr auto ATTACHMENT = GL_COLOR_ATTACHMENT5;
 
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_before_buffer);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_handle);
+        _before_buffer = GLStateCache::get_framebuffer();
+        GLStateCache::bind_framebuffer(_framebuffer_handle);
         glFramebufferTexture2D(GL_FRAMEBUFFER, ATTACHMENT, GL_TEXTURE_2D, get_native_handle(), 0);
         GLenum DrawBuffers[1] = {ATTACHMENT};
         glDrawBuffers(1, DrawBuffers);
+
+        if (not _profiling_name.empty())
+            GPUProfiler::begin_zone(_profiling_name);
     }
 
     void RenderTexture::unbind_as_rendertarget() const
     {
+        if (not _profiling_name.empty())
+            GPUProfiler::end_zone();
+
         //glBindFramebuffer(GL_FRAMEBUFFER, _before_buffer);
     }
+
+    void RenderTexture::set_profiling_name(const std::string& name)
+    {
+        _profiling_name = name;
+    }
 }
\ No newline at end of file
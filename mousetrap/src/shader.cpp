@@ -8,6 +8,7 @@
 #include <fstream>
 #include <sstream>
 #include "mousetrap/include/shader.hpp"
+#include "mousetrap/include/cpu_profiler.hpp"
 
 namespace mousetrap
 {
@@ -23,6 +24,8 @@ namespace mousetrap
         _program_id = _noop_program_id;
         _fragment_shader_id = _noop_fragment_shader_id;
         _vertex_shader_id = _noop_vertex_shader_id;
+
+        update_builtin_uniform_locations();
     }
 
     Shader::~Shader()
@@ -34,7 +37,10 @@ namespace mousetrap
             glDeleteShader(_vertex_shader_id);
 
         if (_program_id != 0 and _program_id != _noop_program_id)
+        {
+            GLStateCache::on_program_deleted(_program_id);
             glDeleteProgram(_program_id);
+        }
     }
 
     void Shader::create_from_string(const std::string& code, ShaderType type)
@@ -45,6 +51,35 @@ namespace mousetrap
             _vertex_shader_id = compile_shader(code, type);
 
         _program_id = link_program(_fragment_shader_id, _vertex_shader_id);
+        update_builtin_uniform_locations();
+
+        // vertex buffers hold mousetrap coordinates, without _projection they would be interpreted as gl coordinates
+
+        if (_program_id != 0 and _vertex_shader_id != _noop_vertex_shader_id and _projection_location == -1)
+            std::cerr << "[WARNING] In Shader::create_from_string: Vertex shader does not use `_projection`, vertices will be drawn in the wrong place. Add `#include <mousetrap>` and transform positions with `to_gl_position`" << std::endl;
+    }
+
+    void Shader::update_builtin_uniform_locations()
+    {
+        _transform_location = get_uniform_location("_transform");
+        _projection_location = get_uniform_location("_projection");
+        _texture_set_location = get_uniform_location("_texture_set");
+        _uniform_block_bindings.clear();
+    }
+
+    int Shader::get_transform_location() const
+    {
+        return _transform_location;
+    }
+
+    int Shader::get_projection_location() const
+    {
+        return _projection_location;
+    }
+
+    int Shader::get_texture_set_location() const
+    {
+        return _texture_set_location;
     }
 
     void Shader::create_from_file(const std::string& path, ShaderType type)
@@ -79,10 +114,34 @@ namespace mousetrap
         return _fragment_shader_id;
     }
 
-    GLNativeHandle Shader::compile_shader(const std::string& source, ShaderType shader_type)
+    std::string Shader::resolve_includes(const std::string& source)
+    {
+        // declarations may only appear once, so later occurrences are removed instead of expanded
+
+        auto out = source;
+        auto position = out.find(_include_directive);
+        if (position == std::string::npos)
+            return out;
+
+        out.replace(position, _include_directive.size(), _include_source);
+        position = out.find(_include_directive, position + _include_source.size());
+
+        while (position != std::string::npos)
+        {
+            out.erase(position, _include_directive.size());
+            position = out.find(_include_directive, position);
+        }
+
+        return out;
+    }
+
+    GLNativeHandle Shader::compile_shader(const std::string& source_in, ShaderType shader_type)
     {
+        MOUSETRAP_PROFILE_ZONE("Shader::compile_shader");
+
         GLNativeHandle id = glCreateShader(static_cast<GLenum>(shader_type));
 
+        auto source = resolve_includes(source_in);
         const char* source_ptr = source.c_str();
         glShaderSource(id, 1, &source_ptr, nullptr);
         glCompileShader(id);
@@ -184,11 +243,81 @@ namespace mousetrap
         glUniformMatrix4fv(get_uniform_location(uniform_name), 1, false, &value.transform[0][0]);
     }
 
+    void Shader::set_uniform_float(int location, float value)
+    {
+        glUniform1f(location, value);
+    }
+
+    void Shader::set_uniform_int(int location, int value)
+    {
+        glUniform1i(location, value);
+    }
+
+    void Shader::set_uniform_uint(int location, glm::uint value)
+    {
+        glUniform1ui(location, value);
+    }
+
+    void Shader::set_uniform_vec2(int location, Vector2f value)
+    {
+        glUniform2f(location, value.x, value.y);
+    }
+
+    void Shader::set_uniform_vec3(int location, Vector3f value)
+    {
+        glUniform3f(location, value.x, value.y, value.z);
+    }
+
+    void Shader::set_uniform_vec4(int location, Vector4f value)
+    {
+        glUniform4f(location, value.x, value.y, value.z, value.w);
+    }
+
+    void Shader::set_uniform_transform(int location, const GLTransform& value)
+    {
+        glUniformMatrix4fv(location, 1, false, &value.transform[0][0]);
+    }
+
     int Shader::get_uniform_location(const std::string& str) const
     {
         return glGetUniformLocation(_program_id, str.c_str());
     }
 
+    int Shader::get_uniform_block_index(const std::string& block_name) const
+    {
+        auto index = glGetUniformBlockIndex(_program_id, block_name.c_str());
+        return index == GL_INVALID_INDEX ? -1 : int(index);
+    }
+
+    void Shader::bind_uniform_block(int block_index, size_t binding_point)
+    {
+        if (block_index < 0)
+            return;
+
+        static constexpr size_t unbound = size_t(-1);
+
+        if (size_t(block_index) >= _uniform_block_bindings.size())
+            _uniform_block_bindings.resize(block_index + 1, unbound);
+
+        if (_uniform_block_bindings.at(block_index) == binding_point)
+            return;
+
+        glUniformBlockBinding(_program_id, block_index, binding_point);
+        _uniform_block_bindings.at(block_index) = binding_point;
+    }
+
+    void Shader::bind_uniform_block(const std::string& block_name, size_t binding_point)
+    {
+        auto index = get_uniform_block_index(block_name);
+        if (index == -1)
+        {
+            std::cerr << "[WARNING] In Shader::bind_uniform_block: Program has no active uniform block named `" << block_name << "`" << std::endl;
+            return;
+        }
+
+        bind_uniform_block(index, binding_point);
+    }
+
     int Shader::get_vertex_position_location()
     {
         return 0;
@@ -203,4 +332,19 @@ namespace mousetrap
     {
         return 2;
     }
+
+    int Shader::get_instance_transform_location()
+    {
+        return 3;
+    }
+
+    int Shader::get_instance_color_location()
+    {
+        return 5;
+    }
+
+    const std::string& Shader::get_noop_instanced_vertex_shader_source()
+    {
+        return _noop_instanced_vertex_shader_source;
+    }
 }
\ No newline at end of file
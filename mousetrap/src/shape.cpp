@@ -6,6 +6,9 @@
 #include "mousetrap/include/shader.hpp"
 #include "mousetrap/include/gl_common.hpp"
 #include "mousetrap/include/shape.hpp"
+#include "mousetrap/include/cpu_profiler.hpp"
+
+#include <iostream>
 
 namespace mousetrap
 {
@@ -13,137 +16,266 @@ namespace mousetrap
     {
         glGenVertexArrays(1, &_vertex_array_id);
         glGenBuffers(1, &_vertex_buffer_id);
+        glGenBuffers(1, &_element_buffer_id);
+
+        // element buffer is fixed, so it is bound once and stays recorded in the vertex array
+
+        GLStateCache::bind_vertex_array(_vertex_array_id);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _element_buffer_id);
+
+        update_vertex_layout();
     }
 
     Shape::~Shape()
     {
+        GLStateCache::on_vertex_array_deleted(_vertex_array_id);
         glDeleteVertexArrays(1, &_vertex_array_id);
         glDeleteBuffers(1, &_vertex_buffer_id);
+        glDeleteBuffers(1, &_element_buffer_id);
     }
 
-    void Shape::initialize()
+    void Shape::set_vertex_format(VertexFormat format)
     {
-        _vertex_data.clear();
-        _vertex_data.reserve(_vertices.size());
+        if (format == _vertex_format)
+            return;
 
-        for (auto &v: _vertices)
-        {
-            _vertex_data.emplace_back();
-            auto &data = _vertex_data.back();
+        _vertex_format = format;
+        update_vertex_layout();
+        upload_vertices();
+    }
 
-            auto as_gl_position = to_gl_position(v.position);
+    VertexFormat Shape::get_vertex_format() const
+    {
+        return _vertex_format;
+    }
 
-            data._position[0] = as_gl_position[0];
-            data._position[1] = as_gl_position[1];
-            data._position[2] = as_gl_position[2];
+    size_t Shape::get_vertex_stride() const
+    {
+        if (_vertex_format == VertexFormat::COMPACT)
+            return sizeof(VertexLayout<VertexFormat::COMPACT>::Data);
+        else
+            return sizeof(VertexLayout<VertexFormat::DEFAULT>::Data);
+    }
 
-            data._color[0] = v.color.r;
-            data._color[1] = v.color.g;
-            data._color[2] = v.color.b;
-            data._color[3] = v.color.a;
+    void Shape::update_vertex_layout()
+    {
+        // attribute layout only changes with the vertex format, it stays recorded in the vertex array
+
+        auto attributes = _vertex_format == VertexFormat::COMPACT
+            ? VertexLayout<VertexFormat::COMPACT>::get_attributes()
+            : VertexLayout<VertexFormat::DEFAULT>::get_attributes();
 
-            data._texture_coordinates[0] = v.texture_coordinates[0];
-            data._texture_coordinates[1] = v.texture_coordinates[1];
+        GLStateCache::bind_vertex_array(_vertex_array_id);
+        glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer_id);
+
+        for (auto& attribute : attributes)
+        {
+            glEnableVertexAttribArray(attribute.location);
+            glVertexAttribPointer(attribute.location,
+                                  attribute.n_components,
+                                  attribute.type,
+                                  attribute.normalized,
+                                  get_vertex_stride(),
+                                  (GLvoid*) attribute.offset
+            );
         }
 
-        update_data(true, true, true);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    template<VertexFormat Format>
+    static typename VertexLayout<Format>::Data& vertex_data_at(std::vector<uint8_t>& data, size_t i)
+    {
+        return reinterpret_cast<typename VertexLayout<Format>::Data*>(data.data())[i];
+    }
+
+    void Shape::write_vertex_position(size_t i)
+    {
+        auto position = _vertices[i].position;
+
+        if (_vertex_format == VertexFormat::COMPACT)
+            VertexLayout<VertexFormat::COMPACT>::write_position(vertex_data_at<VertexFormat::COMPACT>(_vertex_data, i), position);
+        else
+            VertexLayout<VertexFormat::DEFAULT>::write_position(vertex_data_at<VertexFormat::DEFAULT>(_vertex_data, i), position);
     }
 
-    void Shape::update_data(bool update_position, bool update_color, bool update_tex_coords)
+    void Shape::write_vertex_color(size_t i)
     {
-        glBindVertexArray(_vertex_array_id);
+        auto color = _vertices[i].color;
+
+        if (_vertex_format == VertexFormat::COMPACT)
+            VertexLayout<VertexFormat::COMPACT>::write_color(vertex_data_at<VertexFormat::COMPACT>(_vertex_data, i), color);
+        else
+            VertexLayout<VertexFormat::DEFAULT>::write_color(vertex_data_at<VertexFormat::DEFAULT>(_vertex_data, i), color);
+    }
+
+    void Shape::write_vertex_texture_coordinate(size_t i)
+    {
+        auto coordinates = _vertices[i].texture_coordinates;
+
+        if (_vertex_format == VertexFormat::COMPACT)
+            VertexLayout<VertexFormat::COMPACT>::write_texture_coordinates(vertex_data_at<VertexFormat::COMPACT>(_vertex_data, i), coordinates);
+        else
+            VertexLayout<VertexFormat::DEFAULT>::write_texture_coordinates(vertex_data_at<VertexFormat::DEFAULT>(_vertex_data, i), coordinates);
+    }
+
+    void Shape::initialize()
+    {
+        MOUSETRAP_PROFILE_ZONE("Shape::initialize");
+
+        reset_model_transform();
+        upload_vertices();
+    }
+
+    void Shape::upload_vertices()
+    {
+        _bounding_box_valid = false;
+        _vertex_data.assign(_vertices.size() * get_vertex_stride(), 0);
+
+        for (size_t i = 0; i < _vertices.size(); ++i)
+        {
+            write_vertex_position(i);
+            write_vertex_color(i);
+            write_vertex_texture_coordinate(i);
+        }
+
+        // size may have changed, reallocate
+
         glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer_id);
-        glBufferData(GL_ARRAY_BUFFER, _vertex_data.size() * sizeof(VertexInfo), _vertex_data.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, _vertex_data.size(), _vertex_data.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        _dirty_begin = 0;
+        _dirty_end = 0;
+
+        update_indices();
+    }
+
+    void Shape::write_vertex_data(size_t first_vertex)
+    {
+        _bounding_box_valid = false;
+        _vertex_data.resize(_vertices.size() * get_vertex_stride(), 0);
 
-        if (update_position)
+        for (size_t i = first_vertex; i < _vertices.size(); ++i)
         {
-            auto position_location = Shader::get_vertex_position_location();
-            glEnableVertexAttribArray(position_location);
-            glVertexAttribPointer(position_location,
-                                  3,
-                                  GL_FLOAT,
-                                  GL_FALSE,
-                                  sizeof(struct VertexInfo),
-                                  (GLvoid *) (G_STRUCT_OFFSET(struct VertexInfo, _position))
-            );
+            write_vertex_position(i);
+            write_vertex_color(i);
+            write_vertex_texture_coordinate(i);
         }
+    }
 
-        if (update_color)
+    template<typename T>
+    static std::vector<T> narrow_indices(const std::vector<uint32_t>& in)
+    {
+        auto out = std::vector<T>();
+        out.reserve(in.size());
+        for (auto i : in)
+            out.push_back(static_cast<T>(i));
+
+        return out;
+    }
+
+    void Shape::update_indices()
+    {
+        // use the smallest index type that can address all vertices, element buffer binding is part of the vertex array state
+
+        GLStateCache::bind_vertex_array(_vertex_array_id);
+
+        if (_vertices.size() <= size_t(std::numeric_limits<GLubyte>::max()) + 1)
         {
-            auto color_location = Shader::get_vertex_color_location();
-            glEnableVertexAttribArray(color_location);
-            glVertexAttribPointer(color_location,
-                                  4,
-                                  GL_FLOAT,
-                                  GL_FALSE,
-                                  sizeof(struct VertexInfo),
-                                  (GLvoid *) (G_STRUCT_OFFSET(struct VertexInfo, _color))
-            );
+            auto data = narrow_indices<GLubyte>(_indices);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(GLubyte), data.data(), GL_STATIC_DRAW);
+            _index_type = GL_UNSIGNED_BYTE;
+        }
+        else if (_vertices.size() <= size_t(std::numeric_limits<GLushort>::max()) + 1)
+        {
+            auto data = narrow_indices<GLushort>(_indices);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(GLushort), data.data(), GL_STATIC_DRAW);
+            _index_type = GL_UNSIGNED_SHORT;
+        }
+        else
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(GLuint), _indices.data(), GL_STATIC_DRAW);
+            _index_type = GL_UNSIGNED_INT;
         }
 
-        if (update_tex_coords)
+        _n_indices = _indices.size();
+    }
+
+    void Shape::mark_dirty(size_t begin, size_t end)
+    {
+        if (begin >= end)
+            return;
+
+        if (_dirty_begin == _dirty_end)
         {
-            auto texture_coordinate_location = Shader::get_vertex_texture_coordinate_location();
-            glEnableVertexAttribArray(texture_coordinate_location);
-            glVertexAttribPointer(texture_coordinate_location,
-                                  2,
-                                  GL_FLOAT,
-                                  GL_FALSE,
-                                  sizeof(struct VertexInfo),
-                                  (GLvoid *) (G_STRUCT_OFFSET(struct VertexInfo, _texture_coordinates))
-            );
+            _dirty_begin = begin;
+            _dirty_end = end;
+        }
+        else
+        {
+            _dirty_begin = std::min(_dirty_begin, begin);
+            _dirty_end = std::max(_dirty_end, end);
         }
+    }
 
+    void Shape::update_data()
+    {
+        if (_dirty_begin == _dirty_end)
+            return;
+
+        MOUSETRAP_PROFILE_ZONE("Shape::update_data");
+
+        const auto stride = get_vertex_stride();
+
+        glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer_id);
+        glBufferSubData(GL_ARRAY_BUFFER,
+            _dirty_begin * stride,
+            (_dirty_end - _dirty_begin) * stride,
+            _vertex_data.data() + _dirty_begin * stride
+        );
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+
+        _dirty_begin = 0;
+        _dirty_end = 0;
     }
 
-    void Shape::update_position()
+    void Shape::flush_data()
     {
-        for (size_t i = 0; i < _vertices.size(); ++i)
-        {
-            auto& v = _vertices.at(i);
-            auto& data = _vertex_data.at(i);
+        if (_n_open_edits != 0)
+            return;
 
-            auto as_gl_position = to_gl_position(v.position);
+        // lazily built geometry may not be uploaded yet, the dirty range could exceed the buffer otherwise
 
-            data._position[0] = as_gl_position[0];
-            data._position[1] = as_gl_position[1];
-            data._position[2] = as_gl_position[2];
-        }
+        update_geometry();
+        update_data();
+    }
+
+    void Shape::update_position()
+    {
+        for (size_t i = 0; i < _vertices.size(); ++i)
+            write_vertex_position(i);
 
-        update_data(true, false, false);
+        mark_dirty(0, _vertices.size());
+        flush_data();
     }
 
     void Shape::update_color()
     {
         for (size_t i = 0; i < _vertices.size(); ++i)
-        {
-            auto& v = _vertices.at(i);
-            auto& data = _vertex_data.at(i);
+            write_vertex_color(i);
 
-            data._color[0] = v.color.r;
-            data._color[1] = v.color.g;
-            data._color[2] = v.color.b;
-            data._color[3] = v.color.a;
-        }
-
-        update_data(false, true, false);
+        mark_dirty(0, _vertices.size());
+        flush_data();
     }
 
     void Shape::update_texture_coordinate()
     {
         for (size_t i = 0; i < _vertices.size(); ++i)
-        {
-            auto& v = _vertices.at(i);
-            auto& data = _vertex_data.at(i);
+            write_vertex_texture_coordinate(i);
 
-            data._texture_coordinates[0] = v.texture_coordinates[0];
-            data._texture_coordinates[1] = v.texture_coordinates[1];
-        }
-
-        update_data(false, false, true);
+        mark_dirty(0, _vertices.size());
+        flush_data();
     }
 
     void Shape::render(Shader& shader, GLTransform transform)
@@ -151,24 +283,96 @@ namespace mousetrap
         if (not _visible)
             return;
 
-        update_data(false, true, false); // TODO: optimize this away
+        GLStateCache::use_program(shader.get_program_id());
+
+        if (_texture != nullptr)
+            _texture->bind();
+
+        draw(shader, transform);
+    }
 
-        glUseProgram(shader.get_program_id());
-        glUniformMatrix4fv(shader.get_uniform_location("_transform"), 1, GL_FALSE, &(transform.transform[0][0]));
+    void Shape::render_instanced(Shader& shader, GLTransform transform, InstanceBuffer& instances)
+    {
+        if (not _visible)
+            return;
 
-        glUniform1i(shader.get_uniform_location("_texture_set"), _texture != nullptr ? GL_TRUE : GL_FALSE);
+        GLStateCache::use_program(shader.get_program_id());
 
         if (_texture != nullptr)
             _texture->bind();
 
-        glBindVertexArray(_vertex_array_id);
-        glDrawElements(_render_type, _indices.size(), GL_UNSIGNED_INT, _indices.data());
+        draw_instanced(shader, transform, instances);
+    }
+
+    void Shape::set_draw_uniforms(Shader& shader, GLTransform& transform)
+    {
+        auto projection = get_gl_projection() * _model;
+        glUniformMatrix4fv(shader.get_transform_location(), 1, GL_FALSE, &(transform.transform[0][0]));
+        glUniformMatrix4fv(shader.get_projection_location(), 1, GL_FALSE, &(projection[0][0]));
+        glUniform1i(shader.get_texture_set_location(), _texture != nullptr ? GL_TRUE : GL_FALSE);
+    }
 
-        if (_texture != nullptr)
-            _texture->unbind();
+    void Shape::update_geometry()
+    {}
 
-        glBindVertexArray(0);
-        glUseProgram(0);
+    void Shape::draw(Shader& shader, GLTransform transform)
+    {
+        update_geometry();
+        update_data();
+        set_draw_uniforms(shader, transform);
+
+        GLStateCache::bind_vertex_array(_vertex_array_id);
+        glDrawElements(_render_type, _n_indices, _index_type, nullptr);
+    }
+
+    void Shape::draw_instanced(Shader& shader, GLTransform transform, InstanceBuffer& instances)
+    {
+        if (instances.get_n_instances() == 0)
+            return;
+
+        update_geometry();
+        update_data();
+        instances.update_data();
+        set_draw_uniforms(shader, transform);
+
+        GLStateCache::bind_vertex_array(_vertex_array_id);
+        glBindBuffer(GL_ARRAY_BUFFER, instances._buffer_id);
+
+        using InstanceInfo = InstanceBuffer::InstanceInfo;
+
+        auto transform_location = Shader::get_instance_transform_location();
+        for (size_t i = 0; i < 2; ++i)
+        {
+            glEnableVertexAttribArray(transform_location + i);
+            glVertexAttribPointer(transform_location + i,
+                                  3,
+                                  GL_FLOAT,
+                                  GL_FALSE,
+                                  sizeof(InstanceInfo),
+                                  (GLvoid*) (i == 0 ? G_STRUCT_OFFSET(InstanceInfo, _transform_row_0) : G_STRUCT_OFFSET(InstanceInfo, _transform_row_1))
+            );
+            glVertexAttribDivisor(transform_location + i, 1);
+        }
+
+        auto color_location = Shader::get_instance_color_location();
+        glEnableVertexAttribArray(color_location);
+        glVertexAttribPointer(color_location,
+                              4,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              sizeof(InstanceInfo),
+                              (GLvoid*) (G_STRUCT_OFFSET(InstanceInfo, _color))
+        );
+        glVertexAttribDivisor(color_location, 1);
+
+        glDrawElementsInstanced(_render_type, _n_indices, _index_type, nullptr, instances.get_n_instances());
+
+        // instance attributes are not part of the regular layout, so they are disabled again for non-instanced draws
+
+        glDisableVertexAttribArray(transform_location);
+        glDisableVertexAttribArray(transform_location + 1);
+        glDisableVertexAttribArray(color_location);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     std::vector<Vector2f> Shape::sort_by_angle(const std::vector<Vector2f>& in)
@@ -200,7 +404,7 @@ namespace mousetrap
 
     void Shape::as_point(Vector2f a)
     {
-        _vertices = {};
+        _vertices = {Vertex(a.x, a.y, _color)};
         _indices = {0};
         _render_type = GL_POINTS;
         initialize();
@@ -530,8 +734,27 @@ namespace mousetrap
     void Shape::set_vertex_color(size_t i, RGBA color)
     {
         _vertices.at(i).color = color;
-        update_color();
-        update_data(false, true, false);
+        write_vertex_color(i);
+        mark_dirty(i, i+1);
+        flush_data();
+    }
+
+    void Shape::set_vertex_colors(size_t first, std::span<const RGBA> colors)
+    {
+        if (first + colors.size() > _vertices.size())
+        {
+            std::cerr << "[ERROR] In Shape::set_vertex_colors: range " << first << " - " << first + colors.size() << " out of bounds for a shape with " << _vertices.size() << " vertices" << std::endl;
+            return;
+        }
+
+        for (size_t i = 0; i < colors.size(); ++i)
+        {
+            _vertices[first + i].color = colors[i];
+            write_vertex_color(first + i);
+        }
+
+        mark_dirty(first, first + colors.size());
+        flush_data();
     }
 
     RGBA Shape::get_vertex_color(size_t index) const
@@ -541,22 +764,67 @@ namespace mousetrap
 
     void Shape::set_vertex_position(size_t i, Vector3f position)
     {
-        _vertices.at(i).position = position;
-        update_position();
-        update_data(true, false, false);
+        _vertices.at(i).position = to_local_position(position);
+        _bounding_box_valid = false;
+        write_vertex_position(i);
+        mark_dirty(i, i+1);
+        flush_data();
     }
 
-    Vector3f Shape::get_vertex_position(size_t i) const
+    void Shape::set_vertex_positions(size_t first, std::span<const Vector3f> positions)
     {
-        return _vertices.at(i).position;
+        if (first + positions.size() > _vertices.size())
+        {
+            std::cerr << "[ERROR] In Shape::set_vertex_positions: range " << first << " - " << first + positions.size() << " out of bounds for a shape with " << _vertices.size() << " vertices" << std::endl;
+            return;
+        }
+
+        const auto inverse_model = glm::inverse(_model);
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            auto position = positions[i];
+            if (not _model_is_identity)
+                position = Vector3f(inverse_model * Vector4f(position, 1));
+
+            _vertices[first + i].position = position;
+            write_vertex_position(first + i);
+        }
+
+        _bounding_box_valid = false;
+
+        mark_dirty(first, first + positions.size());
+        flush_data();
     }
 
+    Vector3f Shape::get_vertex_position(size_t i) const
+    {
+        return to_world_position(_vertices.at(i).position);
+    }
 
     void Shape::set_vertex_texture_coordinate(size_t i, Vector2f coordinates)
     {
         _vertices.at(i).texture_coordinates = coordinates;
-        update_texture_coordinate();
-        update_data(false, false, true);
+        write_vertex_texture_coordinate(i);
+        mark_dirty(i, i+1);
+        flush_data();
+    }
+
+    void Shape::set_vertex_texture_coordinates(size_t first, std::span<const Vector2f> coordinates)
+    {
+        if (first + coordinates.size() > _vertices.size())
+        {
+            std::cerr << "[ERROR] In Shape::set_vertex_texture_coordinates: range " << first << " - " << first + coordinates.size() << " out of bounds for a shape with " << _vertices.size() << " vertices" << std::endl;
+            return;
+        }
+
+        for (size_t i = 0; i < coordinates.size(); ++i)
+        {
+            _vertices[first + i].texture_coordinates = coordinates[i];
+            write_vertex_texture_coordinate(first + i);
+        }
+
+        mark_dirty(first, first + coordinates.size());
+        flush_data();
     }
 
     Vector2f Shape::get_vertex_texture_coordinate(size_t i) const
@@ -564,6 +832,23 @@ namespace mousetrap
         return _vertices.at(i).texture_coordinates;
     }
 
+    void Shape::begin_edit()
+    {
+        _n_open_edits += 1;
+    }
+
+    void Shape::commit_edit()
+    {
+        if (_n_open_edits == 0)
+        {
+            std::cerr << "[WARNING] In Shape::commit_edit: No edit is in progress, call Shape::begin_edit first" << std::endl;
+            return;
+        }
+
+        _n_open_edits -= 1;
+        flush_data();
+    }
+
     size_t Shape::get_n_vertices() const
     {
         return _vertices.size();
@@ -589,69 +874,88 @@ namespace mousetrap
         return _visible;
     }
 
-    Vector2f Shape::get_centroid() const
+    Vector3f Shape::to_world_position(Vector3f local) const
     {
-        static const auto negative_infinity = std::numeric_limits<float>::min();
-        static const auto positive_infinity = std::numeric_limits<float>::max();
+        if (_model_is_identity)
+            return local;
 
-        Vector3f min = Vector3f(positive_infinity);
-        Vector3f max = Vector3f(negative_infinity);
+        return Vector3f(_model * Vector4f(local, 1));
+    }
 
-        for (auto& v : _vertices)
-        {
-            min.x = std::min(min.x, v.position.x);
-            min.y = std::min(min.y, v.position.y);
-            min.z = std::min(min.z, v.position.z);
-            max.x = std::max(max.x, v.position.x);
-            max.y = std::max(max.y, v.position.y);
-            max.z = std::max(max.z, v.position.z);
-        }
+    Vector3f Shape::to_local_position(Vector3f world) const
+    {
+        if (_model_is_identity)
+            return world;
 
-        return Vector3f(
-        min.x + (max.x - min.x) / 2,
-        min.y + (max.y - min.y) / 2,
-        min.z + (max.z - min.z) / 2
-        );
+        return Vector3f(glm::inverse(_model) * Vector4f(world, 1));
+    }
+
+    void Shape::reset_model_transform()
+    {
+        _model = glm::mat4(1);
+        _model_is_identity = true;
+        _bounding_box_valid = false;
+    }
+
+    GLTransform Shape::get_model_transform() const
+    {
+        auto out = GLTransform();
+        out.transform = _model;
+        return out;
+    }
+
+    Vector2f Shape::get_centroid() const
+    {
+        auto bounds = get_bounding_box();
+        return bounds.top_left + bounds.size / 2.f;
     }
 
     void Shape::set_centroid(Vector2f position)
     {
-        auto delta = position - get_centroid();
-        for (auto& v : _vertices)
-        {
-            v.position.x += delta.x;
-            v.position.y += delta.y;
-        }
+        translate(position - get_centroid());
+    }
 
-        update_position();
-        update_data(true, false, false);
+    void Shape::translate(Vector2f delta)
+    {
+        _model = glm::translate(glm::mat4(1), Vector3f(delta.x, delta.y, 0)) * _model;
+        _model_is_identity = false;
+
+        if (_bounding_box_valid)
+            _bounding_box.top_left += delta;
     }
 
     Rectangle Shape::get_bounding_box() const
     {
+        if (_bounding_box_valid)
+            return _bounding_box;
+
         float min_x = std::numeric_limits<float>::max();
         float min_y = std::numeric_limits<float>::max();
-        float min_z = std::numeric_limits<float>::max();
 
-        float max_x = std::numeric_limits<float>::min();
-        float max_y = std::numeric_limits<float>::min();
-        float max_z = std::numeric_limits<float>::min();
+        float max_x = std::numeric_limits<float>::lowest();
+        float max_y = std::numeric_limits<float>::lowest();
 
         for (auto& v : _vertices)
         {
-            min_x = std::min(min_x, v.position.x);
-            min_y = std::min(min_y, v.position.y);
-            min_z = std::min(min_z, v.position.z);
+            auto position = to_world_position(v.position);
 
-            max_x = std::max(max_x, v.position.x);
-            max_y = std::max(max_y, v.position.y);
-            max_z = std::max(max_z, v.position.z);
+            min_x = std::min(min_x, position.x);
+            min_y = std::min(min_y, position.y);
+
+            max_x = std::max(max_x, position.x);
+            max_y = std::max(max_y, position.y);
         }
 
-        return Rectangle{
-        {min_x, min_y},
-        {max_x - min_x, max_y - min_y}
-        };
+        if (_vertices.empty())
+            _bounding_box = Rectangle{{0, 0}, {0, 0}};
+        else
+            _bounding_box = Rectangle{
+            {min_x, min_y},
+            {max_x - min_x, max_y - min_y}
+            };
+
+        _bounding_box_valid = true;
+        return _bounding_box;
     }
 
     Vector2f Shape::get_top_left() const
@@ -666,33 +970,33 @@ namespace mousetrap
 
     void Shape::set_top_left(Vector2f position)
     {
-        auto delta = position - get_bounding_box().top_left;
-        for (auto& v : _vertices)
-        {
-            v.position.x += delta.x;
-            v.position.y += delta.y;
-        }
-
-        update_position();
-        update_data(true, false, false);
+        translate(position - get_bounding_box().top_left);
     }
 
     void Shape::rotate(Angle angle)
     {
-        auto transform = GLTransform();
-        transform.rotate(angle, to_gl_position(get_centroid()));
+        // y axis points down, negate so the direction matches rotation in gl coordinates
 
-        for (auto& v : _vertices)
-        {
-            auto pos = v.position;
-            pos = to_gl_position(pos);
-            pos = transform.apply_to(pos);
-            pos = from_gl_position(pos);
-            v.position = pos;
-        }
+        auto origin = get_centroid();
+        auto rotation = glm::translate(glm::mat4(1), Vector3f(origin.x, origin.y, 0));
+        rotation = glm::rotate(rotation, -angle.as_radians(), glm::vec3(0, 0, 1));
+        rotation = glm::translate(rotation, Vector3f(-origin.x, -origin.y, 0));
+
+        _model = rotation * _model;
+        _model_is_identity = false;
+        _bounding_box_valid = false;
+    }
+
+    void Shape::scale(float x_factor, float y_factor)
+    {
+        auto origin = get_centroid();
+        auto scale = glm::translate(glm::mat4(1), Vector3f(origin.x, origin.y, 0));
+        scale = glm::scale(scale, Vector3f(x_factor, y_factor, 1));
+        scale = glm::translate(scale, Vector3f(-origin.x, -origin.y, 0));
 
-        update_position();
-        update_data(true, false, false);
+        _model = scale * _model;
+        _model_is_identity = false;
+        _bounding_box_valid = false;
     }
 
     const TextureObject* Shape::get_texture()
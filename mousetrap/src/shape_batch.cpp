@@ -0,0 +1,209 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/shape_batch.hpp"
+
+#include <iostream>
+
+namespace mousetrap
+{
+    ShapeBatch::ShapeBatch()
+        : Shape()
+    {
+        _render_type = GL_TRIANGLES;
+    }
+
+    ShapeBatch::PrimitiveClass ShapeBatch::get_primitive_class(GLenum render_type)
+    {
+        if (render_type == GL_POINTS)
+            return PrimitiveClass::POINTS;
+        else if (render_type == GL_LINES or render_type == GL_LINE_STRIP or render_type == GL_LINE_LOOP)
+            return PrimitiveClass::LINES;
+        else if (render_type == GL_TRIANGLES or render_type == GL_TRIANGLE_FAN or render_type == GL_TRIANGLE_STRIP)
+            return PrimitiveClass::TRIANGLES;
+        else
+            return PrimitiveClass::NONE;
+    }
+
+    void ShapeBatch::add(const Shape& shape)
+    {
+        append(shape);
+    }
+
+    void ShapeBatch::add(const std::vector<const Shape*>& shapes)
+    {
+        size_t n_vertices = _vertices.size();
+        size_t n_indices = _indices.size();
+        for (auto* shape : shapes)
+        {
+            if (shape == nullptr)
+                continue;
+
+            n_vertices += shape->_vertices.size();
+            n_indices += 3 * shape->_indices.size();
+        }
+
+        _vertices.reserve(n_vertices);
+        _indices.reserve(n_indices);
+
+        for (auto* shape : shapes)
+            if (shape != nullptr)
+                append(*shape);
+    }
+
+    void ShapeBatch::append(const Shape& shape)
+    {
+        if (not shape._visible or shape._vertices.empty() or shape._indices.empty())
+            return;
+
+        auto primitive_class = get_primitive_class(shape._render_type);
+        if (primitive_class == PrimitiveClass::NONE)
+            return;
+
+        if (_primitive_class == PrimitiveClass::NONE)
+        {
+            _primitive_class = primitive_class;
+            _render_type = get_independent_render_type(shape._render_type);
+        }
+        else if (_primitive_class != primitive_class)
+        {
+            std::cerr << "[WARNING] In ShapeBatch::add: Shape primitive type is incompatible with the other shapes in this batch, it will be ignored" << std::endl;
+            return;
+        }
+
+        // geometry is baked into the batch in world space, so each shapes model transform is applied here
+
+        const uint32_t offset = _vertices.size();
+        for (auto vertex : shape._vertices)
+        {
+            vertex.position = shape.to_world_position(vertex.position);
+            _vertices.push_back(vertex);
+        }
+
+        // rebase indices and convert strips, fans and loops to independent primitives, so all shapes can share one draw call
+
+        append_independent_indices(shape._render_type, shape._indices, offset, _indices);
+
+        // keep vertex data in sync with the vertices, inherited setters write to it before the batch is uploaded
+        write_vertex_data(offset);
+
+        _n_shapes += 1;
+        _batch_changed = true;
+    }
+
+    GLenum ShapeBatch::get_independent_render_type(GLenum render_type)
+    {
+        switch (get_primitive_class(render_type))
+        {
+            case PrimitiveClass::POINTS:
+                return GL_POINTS;
+            case PrimitiveClass::LINES:
+                return GL_LINES;
+            case PrimitiveClass::TRIANGLES:
+                return GL_TRIANGLES;
+            default:
+                return GL_NONE;
+        }
+    }
+
+    void ShapeBatch::append_independent_indices(GLenum render_type, std::span<const uint32_t> in, uint32_t offset, std::vector<uint32_t>& out)
+    {
+        if (render_type == GL_TRIANGLE_FAN)
+        {
+            for (size_t i = 1; i + 1 < in.size(); ++i)
+            {
+                out.push_back(offset + in[0]);
+                out.push_back(offset + in[i]);
+                out.push_back(offset + in[i+1]);
+            }
+        }
+        else if (render_type == GL_TRIANGLE_STRIP)
+        {
+            for (size_t i = 0; i + 2 < in.size(); ++i)
+            {
+                if (i % 2 == 0)
+                {
+                    out.push_back(offset + in[i]);
+                    out.push_back(offset + in[i+1]);
+                }
+                else
+                {
+                    out.push_back(offset + in[i+1]);
+                    out.push_back(offset + in[i]);
+                }
+                out.push_back(offset + in[i+2]);
+            }
+        }
+        else if (render_type == GL_LINE_STRIP or render_type == GL_LINE_LOOP)
+        {
+            for (size_t i = 0; i + 1 < in.size(); ++i)
+            {
+                out.push_back(offset + in[i]);
+                out.push_back(offset + in[i+1]);
+            }
+
+            if (render_type == GL_LINE_LOOP and in.size() > 2)
+            {
+                out.push_back(offset + in.back());
+                out.push_back(offset + in.front());
+            }
+        }
+        else
+        {
+            for (auto i : in)
+                out.push_back(offset + i);
+        }
+    }
+
+    void ShapeBatch::clear()
+    {
+        _vertices.clear();
+        _indices.clear();
+        _primitive_class = PrimitiveClass::NONE;
+        _render_type = GL_TRIANGLES;
+        _n_shapes = 0;
+        _batch_changed = true;
+
+        write_vertex_data(0);
+    }
+
+    void ShapeBatch::initialize()
+    {
+        // convert to independent primitives, so later calls to add can append to it
+
+        auto indices = std::move(_indices);
+        _indices.clear();
+
+        _primitive_class = get_primitive_class(_render_type);
+        if (_primitive_class == PrimitiveClass::NONE)
+        {
+            _vertices.clear();
+            _render_type = GL_TRIANGLES;
+        }
+        else
+        {
+            append_independent_indices(_render_type, indices, 0, _indices);
+            _render_type = get_independent_render_type(_render_type);
+        }
+
+        _n_shapes = _vertices.empty() ? 0 : 1;
+        _batch_changed = false;
+
+        Shape::initialize();
+    }
+
+    size_t ShapeBatch::get_n_shapes() const
+    {
+        return _n_shapes;
+    }
+
+    void ShapeBatch::update_geometry()
+    {
+        if (not _batch_changed)
+            return;
+
+        upload_vertices();
+        _batch_changed = false;
+    }
+}
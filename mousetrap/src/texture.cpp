@@ -4,7 +4,9 @@
 //
 
 #include <iostream>
+#include <algorithm>
 #include "mousetrap/include/texture.hpp"
+#include "mousetrap/include/cpu_profiler.hpp"
 
 namespace mousetrap
 {
@@ -16,27 +18,148 @@ namespace mousetrap
     Texture::~Texture()
     {
         if (_native_handle != 0)
+        {
+            release_memory();
+            GLStateCache::on_texture_deleted(_native_handle);
             glDeleteTextures(1, &_native_handle);
+        }
+    }
+
+    size_t Texture::get_bytes_per_texel(TextureFormat format)
+    {
+        switch (format)
+        {
+            case TextureFormat::R8:
+                return 1;
+            case TextureFormat::RG8:
+                return 2;
+            case TextureFormat::RGBA8:
+            case TextureFormat::SRGB8_ALPHA8:
+                return 4;
+            case TextureFormat::RGBA16F:
+                return 8;
+            case TextureFormat::RGBA32F:
+                return 16;
+        }
+
+        return 4;
+    }
+
+    void Texture::release_memory()
+    {
+        if (_n_bytes == 0)
+            return;
+
+        auto& entry = _memory_statistics.per_format[_format];
+        entry.n_textures -= 1;
+        entry.n_bytes -= _n_bytes;
+        _memory_statistics.n_bytes -= _n_bytes;
+
+        _n_bytes = 0;
+    }
+
+    void Texture::set_memory_usage(size_t n_bytes)
+    {
+        release_memory();
+
+        _n_bytes = n_bytes;
+        if (_n_bytes != 0)
+        {
+            auto& entry = _memory_statistics.per_format[_format];
+            entry.n_textures += 1;
+            entry.n_bytes += _n_bytes;
+            _memory_statistics.n_bytes += _n_bytes;
+        }
     }
 
-    void Texture::create(size_t width, size_t height)
+    void Texture::upload_level(GLint level, size_t width, size_t height, TextureFormat format, const void* data, GLenum client_format, GLenum client_type, GLint alignment)
     {
-        glActiveTexture(GL_TEXTURE0 + 0);
-        glBindTexture(GL_TEXTURE_2D, _native_handle);
+        GLStateCache::bind_texture(0, _native_handle);
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
         glTexImage2D(GL_TEXTURE_2D,
-             0,
-             GL_RGBA16F,
+             level,
+             static_cast<GLint>(format),
              width,
              height,
              0,
-             GL_RGBA,
-             GL_FLOAT,
-             nullptr
+             client_format,
+             client_type,
+             data
         );
+    }
+
+    void Texture::upload_image(GLint level, const Image& image, TextureFormat format)
+    {
+        const auto width = image.get_size().x;
+        const auto height = image.get_size().y;
 
+        // convert on the cpu to the client format matching the internal format, so the driver uploads without converting
+
+        if (format == TextureFormat::R8 or format == TextureFormat::RG8)
+        {
+            const auto rgba = image.as_format(ImageFormat::RGBA8);
+            const auto* in = static_cast<const uint8_t*>(rgba.data());
+            const size_t n_channels = format == TextureFormat::R8 ? 1 : 2;
+
+            std::vector<uint8_t> packed(width * height * n_channels);
+            for (size_t i = 0; i < width * height; ++i)
+                for (size_t c = 0; c < n_channels; ++c)
+                    packed[i * n_channels + c] = in[i * 4 + c];
+
+            upload_level(level, width, height, format, packed.data(), n_channels == 1 ? GL_RED : GL_RG, GL_UNSIGNED_BYTE, 1);
+        }
+        else if (format == TextureFormat::RGBA16F)
+        {
+            if (image.get_format() == ImageFormat::RGBA16F)
+                upload_level(level, width, height, format, image.data(), GL_RGBA, GL_HALF_FLOAT, 4);
+            else
+                upload_level(level, width, height, format, image.as_format(ImageFormat::RGBA16F).data(), GL_RGBA, GL_HALF_FLOAT, 4);
+        }
+        else if (format == TextureFormat::RGBA32F)
+        {
+            if (image.get_format() == ImageFormat::RGBA32F)
+                upload_level(level, width, height, format, image.data(), GL_RGBA, GL_FLOAT, 4);
+            else
+                upload_level(level, width, height, format, image.as_format(ImageFormat::RGBA32F).data(), GL_RGBA, GL_FLOAT, 4);
+        }
+        else
+        {
+            if (image.get_format() == ImageFormat::RGBA8)
+                upload_level(level, width, height, format, image.data(), GL_RGBA, GL_UNSIGNED_BYTE, 4);
+            else
+                upload_level(level, width, height, format, image.as_format(ImageFormat::RGBA8).data(), GL_RGBA, GL_UNSIGNED_BYTE, 4);
+        }
+    }
+
+    void Texture::on_allocated(size_t width, size_t height, TextureFormat format, size_t n_levels, size_t n_bytes)
+    {
+        // limit sampling to the levels that were uploaded, so a partial chain is still complete
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, n_levels - 1);
+
+        release_memory();
+        _format = format;
         _size = {width, height};
+        _n_levels = n_levels;
+        set_memory_usage(n_bytes);
+
+        // new storage has no mipmaps, they may have to be regenerated on the next bind
+
+        _parameters_changed = true;
+    }
+
+    void Texture::create(size_t width, size_t height, TextureFormat format)
+    {
+        GLenum client_format = GL_RGBA;
+        if (format == TextureFormat::R8)
+            client_format = GL_RED;
+        else if (format == TextureFormat::RG8)
+            client_format = GL_RG;
+
+        upload_level(0, width, height, format, nullptr, client_format, GL_UNSIGNED_BYTE, 4);
+        on_allocated(width, height, format, 1, width * height * get_bytes_per_texel(format));
     }
 
     void Texture::create_from_file(const std::string& path)
@@ -52,47 +175,166 @@ namespace mousetrap
         _native_handle = other._native_handle;
         _size = other._size;
         _wrap_mode = other._wrap_mode;
+        _scale_mode = other._scale_mode;
+        _parameters_changed = other._parameters_changed;
+        _format = other._format;
+        _n_bytes = other._n_bytes;
+        _n_levels = other._n_levels;
+        _lod_bias = other._lod_bias;
 
         other._native_handle = 0;
         other._size = {0, 0};
+        other._n_bytes = 0;
     }
 
     Texture& Texture::operator=(Texture&& other)
     {
+        if (this == &other)
+            return *this;
+
+        if (_native_handle != 0)
+        {
+            release_memory();
+            GLStateCache::on_texture_deleted(_native_handle);
+            glDeleteTextures(1, &_native_handle);
+        }
+
         _native_handle = other._native_handle;
         _size = other._size;
         _wrap_mode = other._wrap_mode;
+        _scale_mode = other._scale_mode;
+        _parameters_changed = other._parameters_changed;
+        _format = other._format;
+        _n_bytes = other._n_bytes;
+        _n_levels = other._n_levels;
+        _lod_bias = other._lod_bias;
 
         other._native_handle = 0;
         other._size = {0, 0};
+        other._n_bytes = 0;
 
         return *this;
     }
 
     void Texture::create_from_image(const Image& image)
     {
-        glActiveTexture(GL_TEXTURE0 + 0);
-        glBindTexture(GL_TEXTURE_2D, _native_handle);
+        if (image.get_format() == ImageFormat::RGBA16F)
+            create_from_image(image, TextureFormat::RGBA16F);
+        else if (image.get_format() == ImageFormat::RGBA32F)
+            create_from_image(image, TextureFormat::RGBA32F);
+        else
+            create_from_image(image, TextureFormat::RGBA8);
+    }
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-        glTexImage2D(GL_TEXTURE_2D,
-             0,
-             GL_RGBA32F,
-             image.get_size().x,
-             image.get_size().y,
-             0,
-             GL_RGBA,
-             GL_FLOAT,
-             image.data()
-        );
+    void Texture::create_from_image(const Image& image, TextureFormat format)
+    {
+        MOUSETRAP_PROFILE_ZONE("Texture::create_from_image");
 
-        _size = image.get_size();
+        const auto width = image.get_size().x;
+        const auto height = image.get_size().y;
+
+        upload_image(0, image, format);
+        on_allocated(width, height, format, 1, width * height * get_bytes_per_texel(format));
+    }
+
+    void Texture::create_from_mipmap_chain(const std::vector<Image>& levels, TextureFormat format)
+    {
+        if (levels.empty())
+        {
+            std::cerr << "[WARNING] In Texture::create_from_mipmap_chain: Chain is empty" << std::endl;
+            return;
+        }
+
+        // validate all levels first, so a bad chain leaves the current storage untouched
+
+        for (size_t level = 0; level < levels.size(); ++level)
+        {
+            const auto& image = levels.at(level);
+            auto expected = Vector2ui(
+                std::max<size_t>(1, levels.front().get_size().x >> level),
+                std::max<size_t>(1, levels.front().get_size().y >> level)
+            );
+
+            if (image.get_size() != expected)
+            {
+                std::cerr << "[ERROR] In Texture::create_from_mipmap_chain: Level " << level << " has size " << image.get_size().x << "x" << image.get_size().y << ", expected " << expected.x << "x" << expected.y << std::endl;
+                return;
+            }
+        }
+
+        size_t n_bytes = 0;
+        for (size_t level = 0; level < levels.size(); ++level)
+        {
+            upload_image(level, levels.at(level), format);
+            n_bytes += levels.at(level).get_n_pixels() * get_bytes_per_texel(format);
+        }
+
+        on_allocated(levels.front().get_size().x, levels.front().get_size().y, format, levels.size(), n_bytes);
+    }
+
+    void Texture::generate_mipmaps()
+    {
+        if (_size.x == 0 or _size.y == 0)
+            return;
+
+        GLStateCache::bind_texture(0, _native_handle);
+        generate_mipmaps_on_bound_unit();
+    }
+
+    void Texture::generate_mipmaps_on_bound_unit()
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // full chain occupies about 4/3 of the base level
+
+        size_t n_levels = 1;
+        size_t n_bytes = 0;
+        for (auto size = Vector2ui(_size.x, _size.y);; size = Vector2ui(std::max<size_t>(1, size.x / 2), std::max<size_t>(1, size.y / 2)), ++n_levels)
+        {
+            n_bytes += size.x * size.y * get_bytes_per_texel(_format);
+            if (size.x == 1 and size.y == 1)
+                break;
+        }
+
+        _n_levels = n_levels;
+        set_memory_usage(n_bytes);
+    }
+
+    bool Texture::has_mipmaps() const
+    {
+        return _n_levels > 1;
+    }
+
+    void Texture::set_lod_bias(float bias)
+    {
+        _lod_bias = bias;
+        _parameters_changed = true;
+    }
+
+    float Texture::get_lod_bias() const
+    {
+        return _lod_bias;
+    }
+
+    TextureFormat Texture::get_format() const
+    {
+        return _format;
+    }
+
+    Texture::MemoryStatistics Texture::get_memory_statistics()
+    {
+        return _memory_statistics;
     }
 
     void Texture::bind(size_t texture_unit) const
     {
-        glActiveTexture(GL_TEXTURE0 + texture_unit);
-        glBindTexture(GL_TEXTURE_2D, _native_handle);
+        GLStateCache::bind_texture(texture_unit, _native_handle);
+
+        // parameters are stored per texture object, so they only need to be set after they changed
+
+        if (not _parameters_changed)
+            return;
 
         if (_wrap_mode == WrapMode::ZERO)
         {
@@ -114,9 +356,30 @@ namespace mousetrap
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLint) _wrap_mode);
         }
 
+        // texture is bound to the active unit, so generating in place leaves all other units untouched
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint) _scale_mode);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint) _scale_mode);
+        if (scale_mode_uses_mipmaps(_scale_mode) and not has_mipmaps() and _size.x != 0 and _size.y != 0)
+            const_cast<Texture*>(this)->generate_mipmaps_on_bound_unit();
+
+        // magnification never uses mipmaps
+
+        GLint min_filter = _scale_mode == ScaleMode::ANISOTROPIC ? GL_LINEAR_MIPMAP_LINEAR : (GLint) _scale_mode;
+        GLint mag_filter = (_scale_mode == ScaleMode::NEAREST or _scale_mode == ScaleMode::NEAREST_MIPMAP) ? GL_NEAREST : GL_LINEAR;
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, _lod_bias);
+
+        if (GLEW_EXT_texture_filter_anisotropic)
+        {
+            float anisotropy = 1;
+            if (_scale_mode == ScaleMode::ANISOTROPIC)
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &anisotropy);
+
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+        }
+
+        _parameters_changed = false;
     }
 
     void Texture::bind() const
@@ -126,12 +389,13 @@ namespace mousetrap
 
     void Texture::unbind() const
     {
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GLStateCache::bind_texture(0, 0);
     }
 
     void Texture::set_wrap_mode(WrapMode wrap_mode)
     {
         _wrap_mode = wrap_mode;
+        _parameters_changed = true;
     }
 
     WrapMode Texture::get_wrap_mode()
@@ -152,6 +416,7 @@ namespace mousetrap
     void Texture::set_scale_mode(ScaleMode mode)
     {
         _scale_mode = mode;
+        _parameters_changed = true;
     }
 
     ScaleMode Texture::get_scale_mode()
@@ -159,15 +424,29 @@ namespace mousetrap
         return _scale_mode;
     }
 
+    std::pair<ImageFormat, GLenum> Texture::get_download_format() const
+    {
+        // float textures are read back without losing precision, all others as RGBA8
+
+        if (_format == TextureFormat::RGBA16F)
+            return {ImageFormat::RGBA16F, GL_HALF_FLOAT};
+        else if (_format == TextureFormat::RGBA32F)
+            return {ImageFormat::RGBA32F, GL_FLOAT};
+        else
+            return {ImageFormat::RGBA8, GL_UNSIGNED_BYTE};
+    }
+
     Image Texture::download() const
     {
+        auto [format, type] = get_download_format();
+
         auto out = Image();
-        out.create(_size.x, _size.y);
+        out.create(_size.x, _size.y, RGBA(0, 0, 0, 0), format);
 
-        glBindTexture(GL_TEXTURE_2D, _native_handle);
-        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, out.data());
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GLStateCache::bind_texture(0, _native_handle);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, type, out.data());
 
         return out;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,275 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/texture_atlas.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+
+namespace mousetrap
+{
+    namespace
+    {
+        /// \brief skyline packer, each segment marks the lowest free y for a range of x, rectangles are placed as high as possible, then as far left as possible
+        class Skyline
+        {
+            public:
+                Skyline(size_t width, size_t height)
+                    : _width(width), _height(height)
+                {
+                    _segments.push_back({0, 0, width});
+                }
+
+                bool insert(size_t width, size_t height, Vector2ui& out)
+                {
+                    size_t best_index = size_t(-1);
+                    size_t best_x = 0, best_y = size_t(-1);
+
+                    for (size_t i = 0; i < _segments.size(); ++i)
+                    {
+                        size_t y;
+                        if (fits(i, width, height, y) and y < best_y)
+                        {
+                            best_index = i;
+                            best_x = _segments[i].x;
+                            best_y = y;
+                        }
+                    }
+
+                    if (best_index == size_t(-1))
+                        return false;
+
+                    place(best_index, best_x, best_y, width, height);
+                    out = {best_x, best_y};
+                    return true;
+                }
+
+            private:
+                struct Segment
+                {
+                    size_t x;
+                    size_t y;
+                    size_t width;
+                };
+
+                bool fits(size_t index, size_t width, size_t height, size_t& y) const
+                {
+                    size_t x = _segments[index].x;
+                    if (x + width > _width)
+                        return false;
+
+                    // rectangle rests on the highest segment it spans
+
+                    y = 0;
+                    size_t remaining = width;
+                    for (size_t i = index; remaining > 0; ++i)
+                    {
+                        y = std::max(y, _segments[i].y);
+                        if (y + height > _height)
+                            return false;
+
+                        remaining -= std::min(remaining, _segments[i].width);
+                    }
+
+                    return true;
+                }
+
+                void place(size_t index, size_t x, size_t y, size_t width, size_t height)
+                {
+                    _segments.insert(_segments.begin() + index, Segment{x, y + height, width});
+
+                    // shrink or remove segments now covered by the new one
+
+                    for (size_t i = index + 1; i < _segments.size();)
+                    {
+                        auto& segment = _segments[i];
+                        if (segment.x >= x + width)
+                            break;
+
+                        size_t overlap = x + width - segment.x;
+                        if (overlap >= segment.width)
+                            _segments.erase(_segments.begin() + i);
+                        else
+                        {
+                            segment.x += overlap;
+                            segment.width -= overlap;
+                            break;
+                        }
+                    }
+
+                    for (size_t i = 0; i + 1 < _segments.size();)
+                    {
+                        if (_segments[i].y == _segments[i+1].y)
+                        {
+                            _segments[i].width += _segments[i+1].width;
+                            _segments.erase(_segments.begin() + i + 1);
+                        }
+                        else
+                            ++i;
+                    }
+                }
+
+                size_t _width, _height;
+                std::vector<Segment> _segments;
+        };
+
+        /// \brief copy image into page at position, surrounded by padding pixels that repeat the edge of the image
+        void blit_extruded(const Image& image, Image& page, Vector2ui position, size_t padding)
+        {
+            const size_t width = image.get_size().x;
+            const size_t height = image.get_size().y;
+            const size_t page_width = page.get_size().x;
+
+            const auto* in = static_cast<const uint8_t*>(image.data());
+            auto* out = static_cast<uint8_t*>(page.data());
+
+            for (size_t y = 0; y < height + 2 * padding; ++y)
+            {
+                size_t source_y = std::clamp<int64_t>(int64_t(y) - int64_t(padding), 0, height - 1);
+                const uint8_t* source_row = in + source_y * width * 4;
+                uint8_t* row = out + ((position.y + y) * page_width + position.x) * 4;
+
+                for (size_t x = 0; x < padding; ++x)
+                    std::memcpy(row + x * 4, source_row, 4);
+
+                std::memcpy(row + padding * 4, source_row, width * 4);
+
+                for (size_t x = 0; x < padding; ++x)
+                    std::memcpy(row + (padding + width + x) * 4, source_row + (width - 1) * 4, 4);
+            }
+        }
+    }
+
+    TextureAtlas::TextureAtlas(size_t page_width, size_t page_height, size_t padding, TextureFormat format)
+        : _page_width(page_width), _page_height(page_height), _padding(padding), _format(format)
+    {}
+
+    TextureAtlas::RegionID TextureAtlas::add(const Image& image)
+    {
+        _images.push_back(image.as_format(ImageFormat::RGBA8));
+        _regions.push_back(Region{0, {0, 0}, image.get_size(), Rectangle{{0, 0}, {0, 0}}});
+        return _images.size() - 1;
+    }
+
+    bool TextureAtlas::build()
+    {
+        // tallest first packs tighter, ties are broken by id so the result is deterministic
+
+        std::vector<size_t> order(_images.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){
+            auto size_a = _images.at(a).get_size();
+            auto size_b = _images.at(b).get_size();
+
+            if (size_a.y != size_b.y)
+                return size_a.y > size_b.y;
+
+            return size_a.x > size_b.x;
+        });
+
+        std::vector<Skyline> skylines;
+        std::vector<Image> page_images;
+        bool success = true;
+
+        for (auto id : order)
+        {
+            const auto& image = _images.at(id);
+            auto& region = _regions.at(id);
+
+            const size_t width = image.get_size().x + 2 * _padding;
+            const size_t height = image.get_size().y + 2 * _padding;
+
+            if (image.get_n_pixels() == 0 or width > _page_width or height > _page_height)
+            {
+                if (image.get_n_pixels() != 0)
+                {
+                    std::cerr << "[WARNING] In TextureAtlas::build: Image of size " << image.get_size().x << "x" << image.get_size().y << " does not fit into a page of size " << _page_width << "x" << _page_height << std::endl;
+                    success = false;
+                }
+
+                region = Region{0, {0, 0}, {0, 0}, Rectangle{{0, 0}, {0, 0}}};
+                continue;
+            }
+
+            // first fit over existing pages, open a new page if none has space
+
+            Vector2ui position;
+            size_t page = 0;
+            while (page < skylines.size() and not skylines.at(page).insert(width, height, position))
+                page += 1;
+
+            if (page == skylines.size())
+            {
+                skylines.emplace_back(_page_width, _page_height);
+                page_images.emplace_back().create(_page_width, _page_height, RGBA(0, 0, 0, 0));
+                skylines.back().insert(width, height, position);
+            }
+
+            blit_extruded(image, page_images.at(page), position, _padding);
+
+            region.page = page;
+            region.position = {position.x + _padding, position.y + _padding};
+            region.size = image.get_size();
+            region.texture_coordinates = Rectangle{
+                {float(region.position.x) / _page_width, float(region.position.y) / _page_height},
+                {float(region.size.x) / _page_width, float(region.size.y) / _page_height}
+            };
+        }
+
+        // existing textures are reused, so shapes pointing at a page stay valid across rebuilds
+
+        for (size_t i = 0; i < page_images.size(); ++i)
+        {
+            if (i >= _pages.size())
+                _pages.emplace_back(new Texture());
+
+            _pages.at(i)->create_from_image(page_images.at(i), _format);
+        }
+
+        _pages.resize(page_images.size());
+        return success;
+    }
+
+    const TextureAtlas::Region& TextureAtlas::get_region(RegionID id) const
+    {
+        return _regions.at(id);
+    }
+
+    size_t TextureAtlas::get_n_regions() const
+    {
+        return _regions.size();
+    }
+
+    const Texture* TextureAtlas::get_page(size_t i) const
+    {
+        return _pages.at(i).get();
+    }
+
+    size_t TextureAtlas::get_n_pages() const
+    {
+        return _pages.size();
+    }
+
+    void TextureAtlas::apply_to(Shape& shape, RegionID id) const
+    {
+        const auto& region = _regions.at(id);
+        if (region.page >= _pages.size() or region.size.x == 0)
+        {
+            std::cerr << "[WARNING] In TextureAtlas::apply_to: Region " << id << " is not part of a built page, call build first" << std::endl;
+            return;
+        }
+
+        const auto& uv = region.texture_coordinates;
+
+        std::vector<Vector2f> coordinates;
+        coordinates.reserve(shape.get_n_vertices());
+        for (size_t i = 0; i < shape.get_n_vertices(); ++i)
+            coordinates.push_back(uv.top_left + shape.get_vertex_texture_coordinate(i) * uv.size);
+
+        shape.set_texture(_pages.at(region.page).get());
+        shape.set_vertex_texture_coordinates(0, coordinates);
+    }
+}
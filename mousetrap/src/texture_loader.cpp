@@ -0,0 +1,230 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/texture_loader.hpp"
+#include "mousetrap/include/cpu_profiler.hpp"
+
+#include <iostream>
+#include <cstring>
+
+namespace mousetrap
+{
+    AsyncTexture::AsyncTexture(const Texture* placeholder)
+        : _placeholder(placeholder)
+    {}
+
+    bool AsyncTexture::is_ready() const
+    {
+        return _state == State::READY;
+    }
+
+    bool AsyncTexture::has_failed() const
+    {
+        return _state == State::FAILED;
+    }
+
+    const Texture* AsyncTexture::get_texture() const
+    {
+        return _state == State::READY ? &_texture : nullptr;
+    }
+
+    void AsyncTexture::bind() const
+    {
+        if (_state == State::READY)
+            _texture.bind();
+        else
+            _placeholder->bind();
+    }
+
+    void AsyncTexture::unbind() const
+    {
+        GLStateCache::bind_texture(0, 0);
+    }
+
+    GLNativeHandle AsyncTexture::get_native_handle() const
+    {
+        return _state == State::READY ? _texture.get_native_handle() : _placeholder->get_native_handle();
+    }
+
+    // ###
+
+    TextureLoader::TextureLoader(size_t n_threads, size_t upload_budget)
+        : _upload_budget(upload_budget)
+    {
+        glGenBuffers(n_pixel_buffers, _pixel_buffers.data());
+
+        auto placeholder = Image();
+        placeholder.create(1, 1, RGBA(0, 0, 0, 0));
+        _placeholder.create_from_image(placeholder);
+
+        for (size_t i = 0; i < n_threads; ++i)
+            _workers.emplace_back(&TextureLoader::worker_main, this);
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        {
+            auto lock = std::lock_guard(_mutex);
+            _should_exit = true;
+        }
+
+        _job_available.notify_all();
+        for (auto& worker : _workers)
+            worker.join();
+
+        glDeleteBuffers(n_pixel_buffers, _pixel_buffers.data());
+    }
+
+    void TextureLoader::set_placeholder(const Image& image)
+    {
+        _placeholder.create_from_image(image);
+    }
+
+    std::shared_ptr<AsyncTexture> TextureLoader::load(const std::string& path, TextureFormat format)
+    {
+        if (format != TextureFormat::RGBA8 and format != TextureFormat::SRGB8_ALPHA8)
+        {
+            std::cerr << "[WARNING] In TextureLoader::load: Only RGBA8 and SRGB8_ALPHA8 are supported, using RGBA8" << std::endl;
+            format = TextureFormat::RGBA8;
+        }
+
+        auto out = std::shared_ptr<AsyncTexture>(new AsyncTexture(&_placeholder));
+
+        {
+            auto lock = std::lock_guard(_mutex);
+            _jobs.push_back({out, path, format});
+        }
+
+        _n_pending += 1;
+        _job_available.notify_one();
+        return out;
+    }
+
+    void TextureLoader::worker_main()
+    {
+        while (true)
+        {
+            Job job;
+
+            {
+                auto lock = std::unique_lock(_mutex);
+                _job_available.wait(lock, [&](){
+                    return _should_exit or not _jobs.empty();
+                });
+
+                if (_should_exit)
+                    return;
+
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+
+            // decoding does not touch gl, only the upload has to happen on the gl thread
+
+            auto image = Image();
+            bool success = image.create_from_file(job.path);
+
+            {
+                auto lock = std::lock_guard(_mutex);
+                _decoded.push_back({std::move(job.target), std::move(image), job.format, success});
+            }
+        }
+    }
+
+    size_t TextureLoader::upload_rows(Upload& upload, size_t max_bytes)
+    {
+        const size_t width = upload.image.get_size().x;
+        const size_t height = upload.image.get_size().y;
+        const size_t row_size = width * 4;
+
+        // at least one row per call, so rows wider than the budget still make progress
+
+        const size_t n_rows = std::min(height - upload.next_row, std::max<size_t>(1, max_bytes / row_size));
+        const size_t n_bytes = n_rows * row_size;
+
+        auto buffer = _pixel_buffers.at(_current_pixel_buffer);
+        _current_pixel_buffer = (_current_pixel_buffer + 1) % n_pixel_buffers;
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, n_bytes, nullptr, GL_STREAM_DRAW);
+
+        auto* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, n_bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped != nullptr)
+        {
+            std::memcpy(mapped, static_cast<const uint8_t*>(upload.image.data()) + upload.next_row * row_size, n_bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+            GLStateCache::bind_texture(0, upload.target->_texture.get_native_handle());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.next_row, width, n_rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        else
+            std::cerr << "[ERROR] In TextureLoader::update: Unable to map pixel buffer" << std::endl;
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        upload.next_row += n_rows;
+        return n_bytes;
+    }
+
+    void TextureLoader::update()
+    {
+        MOUSETRAP_PROFILE_ZONE("TextureLoader::update");
+
+        {
+            auto lock = std::lock_guard(_mutex);
+            while (not _decoded.empty())
+            {
+                _uploads.push_back(std::move(_decoded.front()));
+                _decoded.pop_front();
+            }
+        }
+
+        size_t budget = _upload_budget;
+        while (budget > 0 and not _uploads.empty())
+        {
+            auto& upload = _uploads.front();
+            auto& target = *upload.target;
+
+            if (not upload.success or upload.image.get_n_pixels() == 0)
+            {
+                target._state = AsyncTexture::State::FAILED;
+                _uploads.pop_front();
+                _n_pending -= 1;
+                continue;
+            }
+
+            if (target._state == AsyncTexture::State::DECODING)
+            {
+                target._texture.create(upload.image.get_size().x, upload.image.get_size().y, upload.format);
+                target._state = AsyncTexture::State::UPLOADING;
+            }
+
+            budget -= std::min(budget, upload_rows(upload, budget));
+
+            if (upload.next_row >= upload.image.get_size().y)
+            {
+                target._state = AsyncTexture::State::READY;
+                _uploads.pop_front();
+                _n_pending -= 1;
+            }
+        }
+    }
+
+    void TextureLoader::finish()
+    {
+        while (_n_pending > 0)
+        {
+            update();
+
+            if (_n_pending > 0 and _uploads.empty())
+                std::this_thread::yield();
+        }
+    }
+
+    size_t TextureLoader::get_n_pending() const
+    {
+        return _n_pending;
+    }
+}
@@ -0,0 +1,178 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/texture_readback.hpp"
+
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+
+namespace mousetrap
+{
+    TextureReadback::TextureReadback(size_t n_buffers)
+    {
+        _slots.resize(std::max<size_t>(1, n_buffers));
+        for (auto& slot : _slots)
+            glGenBuffers(1, &slot.buffer);
+    }
+
+    TextureReadback::~TextureReadback()
+    {
+        for (auto& slot : _slots)
+        {
+            if (slot.fence != nullptr)
+                glDeleteSync(slot.fence);
+
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+
+    void TextureReadback::read(const Texture& texture, Callback callback)
+    {
+        // a callback run while waiting may queue a read itself, so recheck the slot after each wait
+
+        while (_slots.at(_next).fence != nullptr)
+        {
+            _n_stalls += 1;
+            resolve(_slots.at(_next), true);
+        }
+
+        auto& slot = _slots.at(_next);
+
+        auto [format, type] = texture.get_download_format();
+        const auto size = Vector2ui(texture.get_size().x, texture.get_size().y);
+        const size_t n_bytes = size.x * size.y * get_bytes_per_pixel(format);
+
+        // buffers only grow, so capturing the same texture every frame does not reallocate
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (n_bytes > slot.capacity)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, n_bytes, nullptr, GL_STREAM_READ);
+            slot.capacity = n_bytes;
+        }
+
+        // with a pack buffer bound, the pointer argument is an offset into it and the call returns without waiting
+
+        GLStateCache::bind_texture(0, texture.get_native_handle());
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, type, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.size = size;
+        slot.format = format;
+        slot.callback = std::move(callback);
+
+        // make sure the fence reaches the gpu, otherwise polling it could never succeed
+        glFlush();
+
+        _next = (_next + 1) % _slots.size();
+        _n_pending += 1;
+    }
+
+    std::future<Image> TextureReadback::read(const Texture& texture)
+    {
+        auto promise = std::make_shared<std::promise<Image>>();
+        auto out = promise->get_future();
+
+        read(texture, [promise](Image image){
+            promise->set_value(std::move(image));
+        });
+
+        return out;
+    }
+
+    bool TextureReadback::resolve(Slot& slot, bool wait)
+    {
+        if (slot.fence == nullptr)
+            return true;
+
+        if (wait)
+        {
+            while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+        }
+        else
+        {
+            auto status = glClientWaitSync(slot.fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED and status != GL_CONDITION_SATISFIED)
+                return false;
+        }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        auto image = Image();
+        image.create(slot.size.x, slot.size.y, RGBA(0, 0, 0, 0), slot.format);
+
+        if (image.get_data_size() != 0)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            auto* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, image.get_data_size(), GL_MAP_READ_BIT);
+
+            if (mapped != nullptr)
+            {
+                std::memcpy(image.data(), mapped, image.get_data_size());
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            else
+                std::cerr << "[ERROR] In TextureReadback::resolve: Unable to map pixel buffer" << std::endl;
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        // callback may queue another read into this slot
+
+        auto callback = std::move(slot.callback);
+        slot.callback = nullptr;
+        _n_pending -= 1;
+
+        if (callback)
+            callback(std::move(image));
+
+        return true;
+    }
+
+    void TextureReadback::update()
+    {
+        // fences signal in submission order, so stop at the first unfinished read
+
+        const size_t n = _slots.size();
+        const size_t oldest = _next;
+
+        for (size_t i = 0; i < n; ++i)
+            if (not resolve(_slots.at((oldest + i) % n), false))
+                return;
+    }
+
+    void TextureReadback::finish()
+    {
+        // callbacks may queue more reads, so wait for the oldest pending read until none are left
+
+        const size_t n = _slots.size();
+        while (_n_pending > 0)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto& slot = _slots.at((_next + i) % n);
+                if (slot.fence != nullptr)
+                {
+                    resolve(slot, true);
+                    break;
+                }
+            }
+        }
+    }
+
+    size_t TextureReadback::get_n_pending() const
+    {
+        return _n_pending;
+    }
+
+    size_t TextureReadback::get_n_stalls() const
+    {
+        return _n_stalls;
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/17/26
+//
+
+#include "mousetrap/include/uniform_buffer.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace mousetrap
+{
+    UniformBufferObject::UniformBufferObject(size_t binding_point, size_t size)
+        : _binding_point(binding_point)
+    {
+        glGenBuffers(1, &_buffer_id);
+        _data.resize(size, 0);
+    }
+
+    UniformBufferObject::~UniformBufferObject()
+    {
+        if (_buffer_id != 0)
+        {
+            GLStateCache::on_buffer_deleted(_buffer_id);
+            glDeleteBuffers(1, &_buffer_id);
+        }
+    }
+
+    size_t UniformBufferObject::get_binding_point() const
+    {
+        return _binding_point;
+    }
+
+    size_t UniformBufferObject::get_size() const
+    {
+        return _data.size();
+    }
+
+    GLNativeHandle UniformBufferObject::get_native_handle() const
+    {
+        return _buffer_id;
+    }
+
+    void UniformBufferObject::write(const void* data, size_t offset, size_t size)
+    {
+        if (std::memcmp(_data.data() + offset, data, size) == 0)
+            return;
+
+        std::memcpy(_data.data() + offset, data, size);
+
+        if (_dirty_begin == _dirty_end)
+        {
+            _dirty_begin = offset;
+            _dirty_end = offset + size;
+        }
+        else
+        {
+            _dirty_begin = std::min(_dirty_begin, offset);
+            _dirty_end = std::max(_dirty_end, offset + size);
+        }
+    }
+
+    const void* UniformBufferObject::read(size_t offset) const
+    {
+        return _data.data() + offset;
+    }
+
+    void UniformBufferObject::update_data()
+    {
+        if (_reallocate)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, _buffer_id);
+            glBufferData(GL_UNIFORM_BUFFER, _data.size(), _data.data(), GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        else if (_dirty_begin != _dirty_end)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, _buffer_id);
+            glBufferSubData(GL_UNIFORM_BUFFER, _dirty_begin, _dirty_end - _dirty_begin, _data.data() + _dirty_begin);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+
+        _reallocate = false;
+        _dirty_begin = 0;
+        _dirty_end = 0;
+    }
+
+    void UniformBufferObject::bind()
+    {
+        update_data();
+        GLStateCache::bind_uniform_buffer(_binding_point, _buffer_id);
+    }
+}